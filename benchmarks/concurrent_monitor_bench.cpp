@@ -0,0 +1,74 @@
+#include <sage/argparse/argparse.hpp>
+#include <sage/performance/monitors.hpp>
+
+#include <mutex>
+
+using namespace sage::performance;
+
+// Baseline that shares a single performance_monitor behind a mutex
+class locked_performance_monitor final : public timer_monitor
+{
+public:
+    void add_measurement(std::chrono::nanoseconds duration) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_monitor.add_measurement(duration);
+    }
+
+private:
+    std::mutex m_mutex;
+    performance_monitor m_monitor;
+};
+
+// Returns recorded measurements per second across all threads
+double run(timer_monitor& monitor, size_t thread_count, size_t iterations)
+{
+    std::atomic<size_t> ready = 0;
+    std::atomic<bool> go = false;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&]() {
+            ++ready;
+            while (!go.load(std::memory_order_acquire)) {}
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                monitor.add_measurement(std::chrono::nanoseconds(i));
+            }
+        });
+    }
+    while (ready.load() != thread_count) {}
+
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(thread_count * iterations) / elapsed.count();
+}
+
+int main(const int argc, char **argv) {
+    auto parser = sage::argparse::argument_parser("sage_concurrent_monitor_bench", "Measures how recording throughput scales with thread count.");
+    parser.add_argument({"-t", "--threads"}).default_value(std::to_string(std::max(2u, std::thread::hardware_concurrency()))).help("Maximum number of recording threads.");
+    parser.add_argument({"-i", "--iterations"}).default_value(std::string("1000000")).help("Measurements recorded per thread.");
+    parser.parse_args(argc, argv);
+
+    const size_t max_threads = std::stoul(parser.get<std::string>("threads"));
+    const size_t iterations = std::stoul(parser.get<std::string>("iterations"));
+
+    std::cout << std::setw(8) << "threads" << std::setw(20) << "locked (M/s)" << std::setw(20) << "concurrent (M/s)" << std::setw(12) << "speedup" << std::endl;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        locked_performance_monitor locked;
+        concurrent_performance_monitor concurrent;
+        const double locked_rate = run(locked, threads, iterations);
+        const double concurrent_rate = run(concurrent, threads, iterations);
+        std::cout << std::setw(8) << threads
+                  << std::setw(20) << std::fixed << std::setprecision(2) << locked_rate / 1e6
+                  << std::setw(20) << concurrent_rate / 1e6
+                  << std::setw(11) << concurrent_rate / locked_rate << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include <sage/performance/benchmark.hpp>
+#include <sage/performance/histogram_monitor.hpp>
+
+using namespace sage::performance;
+
+namespace
+{
+    const auto measurement = std::chrono::microseconds(123);
+
+    streaming_stats_monitor stats;
+    histogram_monitor histogram;
+    concurrent_performance_monitor concurrent;
+}
+
+SAGE_BENCHMARK(streaming_stats_monitor_add_measurement)
+{
+    stats.add_measurement(measurement);
+    clobber_memory();
+}
+
+SAGE_BENCHMARK(histogram_monitor_add_measurement)
+{
+    histogram.add_measurement(measurement);
+    clobber_memory();
+}
+
+SAGE_BENCHMARK(histogram_monitor_p99)
+{
+    do_not_optimize(histogram.p99());
+}
+
+SAGE_BENCHMARK(concurrent_performance_monitor_add_measurement)
+{
+    concurrent.add_measurement(measurement);
+    clobber_memory();
+}
@@ -0,0 +1,3 @@
+#include <sage/performance/benchmark.hpp>
+
+SAGE_BENCHMARK_MAIN()
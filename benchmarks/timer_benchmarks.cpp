@@ -0,0 +1,39 @@
+#include <sage/performance/benchmark.hpp>
+#include <sage/performance/tsc_clock.hpp>
+
+using namespace sage::performance;
+
+namespace
+{
+    // Discards measurements so only the cost of the timer itself is benchmarked
+    class null_monitor final : public timer_monitor
+    {
+    public:
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            do_not_optimize(duration);
+        }
+    };
+
+    null_monitor monitor;
+}
+
+SAGE_BENCHMARK(steady_clock_now)
+{
+    do_not_optimize(std::chrono::steady_clock::now());
+}
+
+SAGE_BENCHMARK(tsc_clock_now)
+{
+    do_not_optimize(tsc_clock::now());
+}
+
+SAGE_BENCHMARK(empty_timer_scope)
+{
+    timer t(monitor);
+}
+
+SAGE_BENCHMARK(empty_tsc_timer_scope)
+{
+    tsc_timer t(monitor);
+}
@@ -3,7 +3,29 @@
 #include "sage/argparse/argparse.hpp"
 #include "sage/performance/timer.hpp"
 #include "sage/performance/timer_monitor.hpp"
+#include "sage/performance/tsc_clock.hpp"
 #include "sage/performance/monitors.hpp"
+#include "sage/performance/histogram_monitor.hpp"
+#include "sage/performance/window_monitor.hpp"
+#include "sage/performance/monitor_registry.hpp"
+#include "sage/performance/binary_log.hpp"
+#include "sage/performance/profiler.hpp"
+#include "sage/performance/trace_monitor.hpp"
+#include "sage/performance/statistics.hpp"
+#include "sage/performance/benchmark.hpp"
+#include "sage/performance/scaling_benchmark.hpp"
+#include "sage/performance/load_generator.hpp"
+#include "sage/performance/compare.hpp"
+#include "sage/performance/async_monitor.hpp"
+#include "sage/performance/sampling_monitor.hpp"
+#include "sage/performance/counter_timer.hpp"
+#include "sage/performance/cpu_timer.hpp"
+#include "sage/performance/memory_timer.hpp"
+#include "sage/performance/lap_timer.hpp"
+#include "sage/performance/throughput_timer.hpp"
+#include "sage/performance/calibration.hpp"
+#include "sage/performance/coroutine_timer.hpp"
+#include "sage/performance/allocation_tracker.hpp"
 #include "sage/string/utilities.hpp"
 #include "sage/term/colours.hpp"
 #include "sage/term/cursor.hpp"
\ No newline at end of file
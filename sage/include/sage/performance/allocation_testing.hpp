@@ -0,0 +1,26 @@
+#pragma once
+
+#include "allocation_tracker.hpp"
+
+#include "gtest/gtest.h"
+
+// googletest assertions that a statement makes no heap allocations on the calling thread.
+// They need allocation tracking to be installed (see allocation_tracker.hpp) and fail if it
+// is not, rather than passing without having counted anything.
+
+#define SAGE_ALLOCATION_CHECK_IMPL(failure_macro, ...) \
+    do \
+    { \
+        failure_macro(::sage::performance::allocation_tracking_installed()) \
+            << "Allocation tracking is not installed, define SAGE_ALLOCATION_TRACKING_IMPLEMENTATION in one translation unit."; \
+        const auto sage_allocations_before = ::sage::performance::thread_allocation_counters(); \
+        __VA_ARGS__; \
+        const auto sage_allocations_after = ::sage::performance::thread_allocation_counters(); \
+        failure_macro(sage_allocations_after.allocations == sage_allocations_before.allocations) \
+            << "Expected no allocations from: " #__VA_ARGS__ "\n  Actual: " \
+            << sage_allocations_after.allocations - sage_allocations_before.allocations << " allocations of " \
+            << sage_allocations_after.bytes_allocated - sage_allocations_before.bytes_allocated << " bytes"; \
+    } while (false)
+
+#define SAGE_EXPECT_NO_ALLOCATIONS(...) SAGE_ALLOCATION_CHECK_IMPL(EXPECT_TRUE, __VA_ARGS__)
+#define SAGE_ASSERT_NO_ALLOCATIONS(...) SAGE_ALLOCATION_CHECK_IMPL(ASSERT_TRUE, __VA_ARGS__)
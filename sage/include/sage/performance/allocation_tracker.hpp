@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Counts heap allocations made through the global operator new and delete, per thread.
+// Tracking is opt-in: define SAGE_ALLOCATION_TRACKING_IMPLEMENTATION in exactly one
+// translation unit of the executable before including this header, that translation unit then
+// replaces the global allocation functions with counting versions. Without it nothing is
+// counted and allocation_tracking_installed() returns false.
+// Counters belong to the thread that calls new or delete, memory freed on a different thread
+// to the one that allocated it counts as freed by the freeing thread.
+
+namespace sage::performance
+{
+    // Running totals for a thread, or the difference between two snapshots of them
+    struct allocation_counters
+    {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        uint64_t bytes_allocated = 0;
+        uint64_t bytes_freed = 0;
+        // Bytes allocated and not yet freed
+        int64_t live_bytes = 0;
+        // Highest live_bytes seen
+        int64_t peak_live_bytes = 0;
+    };
+
+    // Allocations made during one allocation_scope
+    struct allocation_stats
+    {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        uint64_t bytes_allocated = 0;
+        uint64_t bytes_freed = 0;
+        // Highest number of bytes live at once within the scope, over what was live when it began
+        uint64_t peak_live_bytes = 0;
+    };
+
+    namespace detail
+    {
+        inline allocation_counters& local_allocation_counters() noexcept
+        {
+            // Constant initialised so that it is usable from operator new at any point in the
+            // thread's life, including static initialisation and thread exit
+            constinit thread_local allocation_counters counters;
+            return counters;
+        }
+
+        inline bool& allocation_hooks_installed() noexcept
+        {
+            static bool installed = false;
+            return installed;
+        }
+
+        inline void record_allocation(size_t size) noexcept
+        {
+            auto& counters = local_allocation_counters();
+            ++counters.allocations;
+            counters.bytes_allocated += size;
+            counters.live_bytes += static_cast<int64_t>(size);
+            counters.peak_live_bytes = std::max(counters.peak_live_bytes, counters.live_bytes);
+        }
+
+        inline void record_deallocation(size_t size) noexcept
+        {
+            auto& counters = local_allocation_counters();
+            ++counters.deallocations;
+            counters.bytes_freed += size;
+            counters.live_bytes -= static_cast<int64_t>(size);
+        }
+    }
+
+    // True if a translation unit defined SAGE_ALLOCATION_TRACKING_IMPLEMENTATION
+    inline bool allocation_tracking_installed() noexcept
+    {
+        return detail::allocation_hooks_installed();
+    }
+
+    // The calling thread's running totals
+    inline allocation_counters thread_allocation_counters() noexcept
+    {
+        return detail::local_allocation_counters();
+    }
+
+    // Interface for monitors that take the allocations made in a scope
+    class allocation_monitor
+    {
+    public:
+        virtual ~allocation_monitor() = default;
+        virtual void add_measurement(const allocation_stats& stats) = 0;
+    };
+
+    // Totals the allocations of every scope it is given
+    class allocation_summary_monitor final : public allocation_monitor
+    {
+    public:
+        void add_measurement(const allocation_stats& stats) override
+        {
+            ++m_count;
+            m_totals.allocations += stats.allocations;
+            m_totals.deallocations += stats.deallocations;
+            m_totals.bytes_allocated += stats.bytes_allocated;
+            m_totals.bytes_freed += stats.bytes_freed;
+            m_totals.peak_live_bytes = std::max(m_totals.peak_live_bytes, stats.peak_live_bytes);
+        }
+
+        [[nodiscard]] size_t count() const
+        {
+            return m_count;
+        }
+
+        // Summed over every scope, except peak_live_bytes which is the highest of any scope
+        [[nodiscard]] const allocation_stats& totals() const
+        {
+            return m_totals;
+        }
+
+        [[nodiscard]] double average_allocations() const
+        {
+            return static_cast<double>(m_totals.allocations) / static_cast<double>(m_count);
+        }
+
+    private:
+        size_t m_count = 0;
+        allocation_stats m_totals;
+    };
+
+    // RAII scope that reports the allocations made by the current thread between its
+    // construction and destruction. Scopes can be nested, each reports its own peak.
+    class allocation_scope
+    {
+    public:
+        explicit allocation_scope(allocation_monitor& monitor) : m_monitor(monitor)
+        {
+            auto& counters = detail::local_allocation_counters();
+            m_start = counters;
+            // Track the peak of this scope alone, the enclosing peak is restored on exit
+            counters.peak_live_bytes = counters.live_bytes;
+        }
+
+        ~allocation_scope()
+        {
+            const auto stats = current();
+            auto& counters = detail::local_allocation_counters();
+            counters.peak_live_bytes = std::max(m_start.peak_live_bytes, counters.peak_live_bytes);
+            m_monitor.add_measurement(stats);
+        }
+
+        allocation_scope(const allocation_scope&) = delete;
+        allocation_scope& operator=(const allocation_scope&) = delete;
+
+        // Allocations made so far in this scope
+        [[nodiscard]] allocation_stats current() const
+        {
+            const auto& counters = detail::local_allocation_counters();
+            return {counters.allocations - m_start.allocations,
+                    counters.deallocations - m_start.deallocations,
+                    counters.bytes_allocated - m_start.bytes_allocated,
+                    counters.bytes_freed - m_start.bytes_freed,
+                    static_cast<uint64_t>(std::max<int64_t>(counters.peak_live_bytes - m_start.live_bytes, 0))};
+        }
+
+    private:
+        allocation_monitor& m_monitor;
+        allocation_counters m_start;
+    };
+}
+
+#if defined(SAGE_ALLOCATION_TRACKING_IMPLEMENTATION)
+
+namespace sage::performance::detail
+{
+    // The requested size is stored just before the returned pointer, in a header as large as
+    // the alignment, so that unsized deletes can count the bytes they free
+    inline size_t allocation_header_size(size_t alignment) noexcept
+    {
+        return std::max<size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    }
+
+    inline void* tracked_allocate(size_t size, size_t alignment) noexcept
+    {
+        const size_t header = allocation_header_size(alignment);
+        void* base;
+        if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            base = std::malloc(size + header);
+        }
+        else
+        {
+#if defined(_MSC_VER)
+            base = _aligned_malloc(size + header, alignment);
+#else
+            // aligned_alloc requires the size to be a multiple of the alignment
+            base = std::aligned_alloc(alignment, (size + header + alignment - 1) / alignment * alignment);
+#endif
+        }
+        if (base == nullptr)
+        {
+            return nullptr;
+        }
+        auto* pointer = static_cast<char*>(base) + header;
+        reinterpret_cast<size_t*>(pointer)[-1] = size;
+        record_allocation(size);
+        return pointer;
+    }
+
+    inline void tracked_deallocate(void* pointer, size_t alignment) noexcept
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+        record_deallocation(static_cast<size_t*>(pointer)[-1]);
+        void* base = static_cast<char*>(pointer) - allocation_header_size(alignment);
+        if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            std::free(base);
+        }
+        else
+        {
+#if defined(_MSC_VER)
+            _aligned_free(base);
+#else
+            std::free(base);
+#endif
+        }
+    }
+
+    // Follows the standard operator new, calling the new handler until it succeeds or throws
+    inline void* tracked_allocate_or_throw(size_t size, size_t alignment)
+    {
+        for (;;)
+        {
+            if (void* pointer = tracked_allocate(size, alignment))
+            {
+                return pointer;
+            }
+            auto handler = std::get_new_handler();
+            if (handler == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    inline const bool allocation_hooks_registered = (allocation_hooks_installed() = true);
+}
+
+void* operator new(std::size_t size)
+{
+    return sage::performance::detail::tracked_allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size)
+{
+    return sage::performance::detail::tracked_allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return sage::performance::detail::tracked_allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return sage::performance::detail::tracked_allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return sage::performance::detail::tracked_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return sage::performance::detail::tracked_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return sage::performance::detail::tracked_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return sage::performance::detail::tracked_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    sage::performance::detail::tracked_deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+#endif
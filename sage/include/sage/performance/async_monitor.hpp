@@ -0,0 +1,196 @@
+#pragma once
+
+#include "timer_monitor.hpp"
+#include "bounded_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace sage::performance
+{
+    // What async_monitor does with a measurement when its buffer is full
+    enum class overflow_policy
+    {
+        // Discard the measurement
+        drop,
+        // Wait for the background thread to make room
+        block,
+        // Discard the measurement and count it, see async_monitor::dropped()
+        count_dropped
+    };
+
+    // Moves reporting off the timed thread. Measurements are pushed into a bounded lock-free
+    // ring buffer and a background thread forwards them to the wrapped monitor, so a slow
+    // monitor (e.g. cout_monitor) no longer adds to the time of the code being measured.
+    // The wrapped monitor is only ever called from the background thread, so it does not need
+    // to be thread safe, but it should only be read after flush() or stop().
+    class async_monitor final : public timer_monitor
+    {
+    public:
+        explicit async_monitor(timer_monitor& monitor,
+                               size_t capacity = 8192,
+                               overflow_policy policy = overflow_policy::count_dropped,
+                               std::chrono::microseconds idle_poll_interval = std::chrono::microseconds(500))
+            : m_monitor(monitor)
+            , m_queue(capacity)
+            , m_policy(policy)
+            , m_idle_poll_interval(idle_poll_interval)
+            , m_worker([this]() { run(); })
+        {
+        }
+
+        ~async_monitor() override
+        {
+            stop();
+        }
+
+        async_monitor(const async_monitor&) = delete;
+        async_monitor& operator=(const async_monitor&) = delete;
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            if (push(duration))
+            {
+                // A push that raced with stop() may have missed the final drain. Either stop()
+                // sees it and discards it, or this sees stop() finished and discards it here,
+                // both count it as dropped (the fences pair with the one in stop())
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (m_stopped.load(std::memory_order_relaxed))
+                {
+                    discard_buffered();
+                }
+            }
+        }
+
+        // Waits until every measurement added so far has been forwarded
+        void flush()
+        {
+            const size_t target = m_queue.pushed();
+            while (m_forwarded.load(std::memory_order_acquire) < target && !m_stopped.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // Forwards everything still buffered and stops the background thread. Measurements added
+        // after stopping, or whose push raced with it and came too late to forward, are dropped
+        void stop()
+        {
+            m_stopping.store(true, std::memory_order_seq_cst);
+            if (m_worker.joinable())
+            {
+                m_worker.join();
+            }
+            m_stopped.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // Producers that claimed a slot before seeing the stop flag finish writing it
+            while (m_queue.popped() != m_queue.pushed())
+            {
+                discard_buffered();
+                std::this_thread::yield();
+            }
+        }
+
+        // Measurements dropped under overflow_policy::count_dropped, or added after stopping
+        [[nodiscard]] uint64_t dropped() const
+        {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t capacity() const
+        {
+            return m_queue.capacity();
+        }
+
+    private:
+        // Returns true if the measurement went into the buffer
+        bool push(std::chrono::nanoseconds duration)
+        {
+            if (m_stopping.load(std::memory_order_acquire))
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (m_queue.try_push(duration))
+            {
+                return true;
+            }
+            if (m_policy == overflow_policy::block)
+            {
+                while (!m_stopping.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                    if (m_queue.try_push(duration))
+                    {
+                        return true;
+                    }
+                }
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (m_policy == overflow_policy::count_dropped)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        }
+
+        // Empties the buffer after the background thread has finished, counting what was left
+        // as dropped without calling the wrapped monitor
+        void discard_buffered()
+        {
+            std::chrono::nanoseconds duration;
+            while (m_queue.try_pop(duration))
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Forwards everything currently buffered, returns false if there was nothing to forward
+        bool drain()
+        {
+            std::chrono::nanoseconds duration;
+            bool forwarded_any = false;
+            while (m_queue.try_pop(duration))
+            {
+                m_monitor.add_measurement(duration);
+                m_forwarded.fetch_add(1, std::memory_order_release);
+                forwarded_any = true;
+            }
+            return forwarded_any;
+        }
+
+        void run()
+        {
+            for (;;)
+            {
+                const bool forwarded_any = drain();
+                if (m_stopping.load(std::memory_order_acquire))
+                {
+                    // Drain anything pushed between the last pop and seeing the stop request
+                    drain();
+                    return;
+                }
+                if (!forwarded_any)
+                {
+                    std::this_thread::sleep_for(m_idle_poll_interval);
+                }
+            }
+        }
+
+    private:
+        timer_monitor& m_monitor;
+        detail::bounded_queue<std::chrono::nanoseconds> m_queue;
+        overflow_policy m_policy;
+        std::chrono::microseconds m_idle_poll_interval;
+        // Set first by stop(), new measurements are dropped and the background thread drains
+        // the buffer and exits
+        std::atomic<bool> m_stopping{false};
+        // Set once the background thread has exited, anything still buffered is dropped
+        std::atomic<bool> m_stopped{false};
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<size_t> m_forwarded{0};
+        std::thread m_worker;
+    };
+}
@@ -0,0 +1,400 @@
+#pragma once
+
+#include "sage/argparse/argparse.hpp"
+
+#include "calibration.hpp"
+#include "monitors.hpp"
+#include "scaling_benchmark.hpp"
+#include "statistics.hpp"
+#include "timer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace sage::performance
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    namespace detail
+    {
+        __declspec(noinline) inline void use_char_pointer(char const volatile*)
+        {
+        }
+    }
+
+    // Forces the value to be computed and stored, so the compiler can not optimise away the
+    // code producing it
+    template <typename T>
+    inline void do_not_optimize(T const& value)
+    {
+        detail::use_char_pointer(&reinterpret_cast<char const volatile&>(value));
+        _ReadWriteBarrier();
+    }
+
+    // Forces pending writes to memory to be completed, so the compiler can not drop them
+    inline void clobber_memory()
+    {
+        _ReadWriteBarrier();
+    }
+#else
+    // Forces the value to be computed and stored, so the compiler can not optimise away the
+    // code producing it
+    template <typename T>
+    inline void do_not_optimize(T const& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Forces pending writes to memory to be completed, so the compiler can not drop them
+    inline void clobber_memory()
+    {
+        asm volatile("" : : : "memory");
+    }
+#endif
+
+    struct benchmark_options
+    {
+        // Time each repetition should run for, the iteration count is chosen to hit it
+        std::chrono::nanoseconds target_time = std::chrono::milliseconds(50);
+        // Time spent running the benchmark before anything is measured
+        std::chrono::nanoseconds warmup_time = std::chrono::milliseconds(20);
+        size_t repetitions = 10;
+        size_t max_iterations = 1000000000;
+        // Takes the calibrated timer overhead off each timed batch, see calibration.hpp
+        bool subtract_timer_overhead = true;
+    };
+
+    struct benchmark_result
+    {
+        std::string name;
+        // Iterations run in each repetition
+        size_t iterations = 0;
+        // Nanoseconds per iteration of each repetition
+        std::vector<double> samples;
+        // Nanoseconds taken off each timed batch before dividing by the iterations
+        double timer_overhead = 0.0;
+
+        [[nodiscard]] double mean() const {
+            return statistics::mean(samples);
+        }
+
+        [[nodiscard]] double median() const {
+            return statistics::median(samples);
+        }
+
+        [[nodiscard]] double stddev() const {
+            return statistics::stddev(samples);
+        }
+
+        [[nodiscard]] double min() const {
+            return statistics::min(samples);
+        }
+    };
+
+    // Runs func in batches timed with steady_clock. After warming up, the batch size is grown
+    // until a batch takes a tenth of the target time and then scaled to hit the target, each
+    // repetition then times one batch of that many iterations. Batches read the clock directly
+    // rather than through measure(), so benchmarks still work with SAGE_PERFORMANCE_DISABLE.
+    template <typename FuncT>
+    benchmark_result run_benchmark(const std::string& name, FuncT&& func, const benchmark_options& options = {})
+    {
+        const double overhead_ns = options.subtract_timer_overhead ? calibrated_timer_overhead().median : 0.0;
+        auto time_batch = [&func, overhead_ns](size_t iterations) {
+            const auto start = detail::start_now<std::chrono::steady_clock>();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                func();
+            }
+            const auto end = detail::stop_now<std::chrono::steady_clock>();
+            const double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+            return std::max(elapsed_ns - overhead_ns, 0.0);
+        };
+
+        const auto warmup_start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - warmup_start < options.warmup_time)
+        {
+            func();
+        }
+
+        const auto target_ns = static_cast<double>(options.target_time.count());
+        size_t iterations = 1;
+        while (iterations < options.max_iterations)
+        {
+            const double elapsed_ns = time_batch(iterations);
+            if (elapsed_ns >= target_ns / 10.0)
+            {
+                const double scaled = std::ceil(static_cast<double>(iterations) * target_ns / elapsed_ns);
+                iterations = static_cast<size_t>(std::min(scaled, static_cast<double>(options.max_iterations)));
+                break;
+            }
+            iterations = std::min(iterations * 10, options.max_iterations);
+        }
+        iterations = std::max<size_t>(iterations, 1);
+
+        benchmark_result result{name, iterations, {}, overhead_ns};
+        result.samples.reserve(options.repetitions);
+        for (size_t r = 0; r < options.repetitions; ++r)
+        {
+            result.samples.push_back(time_batch(iterations) / static_cast<double>(iterations));
+        }
+        return result;
+    }
+
+    class benchmark_registry
+    {
+    public:
+        using runner_t = std::function<benchmark_result(const benchmark_options&)>;
+        using scaling_runner_t = std::function<scaling_result(const scaling_options&)>;
+
+        static benchmark_registry& instance()
+        {
+            static benchmark_registry registry;
+            return registry;
+        }
+
+        template <typename FuncT>
+        bool add(const std::string& name, FuncT func)
+        {
+            m_benchmarks.push_back({name,
+                                    [name, func](const benchmark_options& options) { return run_benchmark(name, func, options); },
+                                    [name, func](const scaling_options& options) { return run_scaling_benchmark(name, func, options); }});
+            return true;
+        }
+
+        [[nodiscard]] std::vector<std::string> names() const
+        {
+            std::vector<std::string> names;
+            for (const auto& benchmark : m_benchmarks)
+            {
+                names.push_back(benchmark.name);
+            }
+            return names;
+        }
+
+        // Runs every benchmark whose name matches the filter, in registration order
+        std::vector<benchmark_result> run(const benchmark_options& options, const std::regex& filter, const std::function<void(const benchmark_result&)>& on_result = {}) const
+        {
+            std::vector<benchmark_result> results;
+            for (const auto& benchmark : m_benchmarks)
+            {
+                if (!std::regex_search(benchmark.name, filter))
+                {
+                    continue;
+                }
+                results.push_back(benchmark.runner(options));
+                if (on_result)
+                {
+                    on_result(results.back());
+                }
+            }
+            return results;
+        }
+
+        // Runs every benchmark whose name matches the filter on increasing thread counts, the
+        // benchmark bodies must be safe to call from several threads at once
+        std::vector<scaling_result> run_scaling(const scaling_options& options, const std::regex& filter, const std::function<void(const scaling_result&)>& on_result = {}) const
+        {
+            std::vector<scaling_result> results;
+            for (const auto& benchmark : m_benchmarks)
+            {
+                if (!std::regex_search(benchmark.name, filter))
+                {
+                    continue;
+                }
+                results.push_back(benchmark.scaling_runner(options));
+                if (on_result)
+                {
+                    on_result(results.back());
+                }
+            }
+            return results;
+        }
+
+    private:
+        struct registered_benchmark
+        {
+            std::string name;
+            runner_t runner;
+            scaling_runner_t scaling_runner;
+        };
+
+        std::vector<registered_benchmark> m_benchmarks;
+    };
+
+    inline void write_benchmark_table_header(std::ostream& stream)
+    {
+        stream << std::left << std::setw(48) << "benchmark" << std::right << std::setw(14) << "iterations"
+               << std::setw(14) << "mean" << std::setw(14) << "median" << std::setw(14) << "stddev" << std::setw(14) << "min" << std::endl;
+    }
+
+    inline void write_benchmark_table_row(std::ostream& stream, const benchmark_result& result)
+    {
+        stream << std::left << std::setw(48) << result.name << std::right << std::setw(14) << result.iterations
+               << std::setw(14) << format_duration(std::chrono::duration<double, std::nano>(result.mean()))
+               << std::setw(14) << format_duration(std::chrono::duration<double, std::nano>(result.median()))
+               << std::setw(14) << format_duration(std::chrono::duration<double, std::nano>(result.stddev()))
+               << std::setw(14) << format_duration(std::chrono::duration<double, std::nano>(result.min())) << std::endl;
+    }
+
+    // One row per repetition: name,repetition,iterations,ns_per_iteration
+    inline void write_benchmark_csv(std::ostream& stream, const std::vector<benchmark_result>& results)
+    {
+        const auto precision = stream.precision(17);
+        stream << "name,repetition,iterations,ns_per_iteration\n";
+        for (const auto& result : results)
+        {
+            for (size_t r = 0; r < result.samples.size(); ++r)
+            {
+                stream << result.name << "," << r << "," << result.iterations << "," << result.samples[r] << "\n";
+            }
+        }
+        stream.precision(precision);
+    }
+
+    namespace detail
+    {
+        // Parses a whole option value as a non-negative integer, std::stoul alone accepts
+        // trailing text and wraps negative numbers around
+        inline size_t parse_count(sage::argparse::argument_parser& parser, const std::string& name)
+        {
+            const auto text = parser.get<std::string>(name);
+            const bool digits = !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+            try
+            {
+                if (digits)
+                {
+                    return static_cast<size_t>(std::stoull(text));
+                }
+            }
+            catch (const std::out_of_range&)
+            {
+            }
+            throw std::invalid_argument("Error: --" + name + " must be a whole number, not " + text + ".");
+        }
+
+        inline std::regex parse_filter(const std::string& filter)
+        {
+            try
+            {
+                return std::regex(filter);
+            }
+            catch (const std::regex_error&)
+            {
+                throw std::invalid_argument("Error: --filter " + filter + " is not a valid regular expression.");
+            }
+        }
+    }
+
+    // Command line entry point for a benchmark executable, runs the registered benchmarks
+    inline int run_benchmarks(int argc, char** argv)
+    {
+        auto parser = sage::argparse::argument_parser("", "Runs the registered benchmarks.");
+        parser.add_argument({"-f", "--filter"}).default_value(std::string(".*")).help("Only run benchmarks whose name matches this regular expression.");
+        parser.add_argument({"-r", "--repetitions"}).default_value(std::string("10")).help("Number of timed repetitions of each benchmark.");
+        parser.add_argument({"-t", "--target-time"}).default_value(std::string("50")).help("Target time of each repetition in milliseconds.");
+        parser.add_argument({"-w", "--warmup-time"}).default_value(std::string("20")).help("Warmup time before each benchmark in milliseconds.");
+        parser.add_argument({"-o", "--output"}).default_value(std::string("")).help("Write the per repetition results to this CSV file.");
+        parser.add_argument({"-n", "--no-overhead-correction"}).num_args(0).help("Do not take the calibrated timer overhead off the measurements.");
+        parser.add_argument({"-s", "--scaling"}).num_args(0).help("Run each benchmark on 1, 2, 4 ... threads and report how it scales.");
+        parser.add_argument({"-j", "--threads"}).default_value(std::string("0")).help("Largest thread count in scaling mode, the number of hardware threads when 0.");
+        parser.add_argument({"-p", "--pin"}).num_args(0).help("Pin each thread to its own CPU in scaling mode.");
+        parser.add_argument({"-l", "--list"}).num_args(0).help("List the benchmarks and exit.");
+        parser.parse_args(argc, argv);
+
+        auto& registry = benchmark_registry::instance();
+        if (parser.get<bool>("list"))
+        {
+            for (const auto& name : registry.names())
+            {
+                std::cout << name << std::endl;
+            }
+            return 0;
+        }
+
+        try
+        {
+            const auto filter = detail::parse_filter(parser.get<std::string>("filter"));
+            const auto repetitions = detail::parse_count(parser, "repetitions");
+            if (repetitions == 0)
+            {
+                throw std::invalid_argument("Error: --repetitions must be at least 1.");
+            }
+            const auto target_time = std::chrono::milliseconds(detail::parse_count(parser, "target-time"));
+            const auto warmup_time = std::chrono::milliseconds(detail::parse_count(parser, "warmup-time"));
+
+            if (parser.get<bool>("scaling"))
+            {
+                scaling_options options;
+                options.repetitions = repetitions;
+                options.target_time = target_time;
+                options.warmup_time = warmup_time;
+                options.max_threads = detail::parse_count(parser, "threads");
+                options.pin_threads = parser.get<bool>("pin");
+                registry.run_scaling(options, filter, [](const scaling_result& result) {
+                    write_scaling_table(std::cout, result);
+                    std::cout << std::endl;
+                });
+                return 0;
+            }
+
+            benchmark_options options;
+            options.repetitions = repetitions;
+            options.target_time = target_time;
+            options.warmup_time = warmup_time;
+            options.subtract_timer_overhead = !parser.get<bool>("no-overhead-correction");
+
+            std::cout << calibrated_timer_overhead().s_summary() << (options.subtract_timer_overhead ? ", subtracted" : ", not subtracted") << std::endl;
+
+            write_benchmark_table_header(std::cout);
+            const auto results = registry.run(options, filter, [](const benchmark_result& result) {
+                write_benchmark_table_row(std::cout, result);
+            });
+
+            const auto output = parser.get<std::string>("output");
+            if (!output.empty())
+            {
+                std::ofstream file(output);
+                if (!file)
+                {
+                    throw std::runtime_error("Error: Unable to open " + output + " for writing.");
+                }
+                write_benchmark_csv(file, results);
+            }
+            return 0;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+
+#define SAGE_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define SAGE_BENCHMARK_CONCAT(a, b) SAGE_BENCHMARK_CONCAT_IMPL(a, b)
+
+// Defines and registers a benchmark, the body is the code run once per iteration
+#define SAGE_BENCHMARK(name) \
+    static void name(); \
+    static const bool SAGE_BENCHMARK_CONCAT(sage_benchmark_registered_, name) = ::sage::performance::benchmark_registry::instance().add(#name, []() { name(); }); \
+    static void name()
+
+#define SAGE_BENCHMARK_MAIN() \
+    int main(int argc, char** argv) \
+    { \
+        return ::sage::performance::run_benchmarks(argc, argv); \
+    }
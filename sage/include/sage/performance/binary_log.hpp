@@ -0,0 +1,436 @@
+#pragma once
+
+#include "platform.hpp"
+#include "timer_monitor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Append only binary log of raw measurements, far smaller and faster to write and read than
+// printing them as text. Layout, all integers little endian:
+//   header      "SAGELOG\0", uint32 version, uint32 reserved, int64 start time in nanoseconds
+//               since the system_clock epoch
+//   name record 0x01, varint monitor id, varint length, name bytes
+//   measurement 0x02, varint monitor id, varint nanoseconds since the previous measurement
+//               (the first is since the start time), zigzag varint duration in nanoseconds
+// Varints are unsigned LEB128, 7 bits a byte. A monitor's name record always comes before its
+// measurements, and a record cut short at the end of the file (e.g. by a crash) is ignored.
+
+namespace sage::performance
+{
+    namespace detail
+    {
+        inline constexpr std::array<char, 8> binary_log_magic = {'S', 'A', 'G', 'E', 'L', 'O', 'G', '\0'};
+        inline constexpr uint32_t binary_log_version = 1;
+        inline constexpr size_t binary_log_header_size = 24;
+        inline constexpr uint8_t binary_log_name_tag = 0x01;
+        inline constexpr uint8_t binary_log_measurement_tag = 0x02;
+
+        inline void append_varint(std::vector<uint8_t>& buffer, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                buffer.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back(static_cast<uint8_t>(value));
+        }
+
+        inline uint64_t zigzag_encode(int64_t value)
+        {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        inline int64_t zigzag_decode(uint64_t value)
+        {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        // Returns false if the varint runs past end
+        inline bool read_varint(const uint8_t*& position, const uint8_t* end, uint64_t& value)
+        {
+            value = 0;
+            for (int shift = 0; position != end && shift < 64; shift += 7)
+            {
+                const uint8_t byte = *position++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    // Streams measurements to a binary log file through an in memory buffer, which is written
+    // out when it fills, on flush() and on destruction. Thread safe.
+    class binary_log_writer
+    {
+    public:
+        explicit binary_log_writer(const std::filesystem::path& file_path, size_t buffer_size = 1 << 16)
+            : m_file(file_path, std::ios::binary | std::ios::trunc)
+            , m_buffer_size(buffer_size)
+            , m_start(std::chrono::steady_clock::now())
+        {
+            if (!m_file)
+            {
+                throw std::runtime_error("Error: Unable to open binary log " + file_path.string() + " for writing.");
+            }
+            m_buffer.reserve(m_buffer_size + 32);
+
+            const int64_t start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            m_buffer.insert(m_buffer.end(), detail::binary_log_magic.begin(), detail::binary_log_magic.end());
+            append_little_endian(detail::binary_log_version, 4);
+            append_little_endian(0, 4);
+            append_little_endian(static_cast<uint64_t>(start_ns), 8);
+        }
+
+        binary_log_writer(const binary_log_writer&) = delete;
+        binary_log_writer& operator=(const binary_log_writer&) = delete;
+
+        ~binary_log_writer()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            write_buffer();
+        }
+
+        // Writes the name record and returns the id measurements for it are logged under
+        uint32_t register_monitor(std::string_view name)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const uint32_t id = m_next_id++;
+            m_buffer.push_back(detail::binary_log_name_tag);
+            detail::append_varint(m_buffer, id);
+            detail::append_varint(m_buffer, name.size());
+            m_buffer.insert(m_buffer.end(), name.begin(), name.end());
+            write_buffer_if_full();
+            return id;
+        }
+
+        // Logs a measurement, timestamped now
+        void record(uint32_t monitor_id, std::chrono::nanoseconds duration)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Taken under the lock so timestamps in the file never go backwards
+            const int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+            m_buffer.push_back(detail::binary_log_measurement_tag);
+            detail::append_varint(m_buffer, monitor_id);
+            detail::append_varint(m_buffer, static_cast<uint64_t>(timestamp - m_last_timestamp));
+            detail::append_varint(m_buffer, detail::zigzag_encode(duration.count()));
+            m_last_timestamp = timestamp;
+            write_buffer_if_full();
+        }
+
+        void flush()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            write_buffer();
+            m_file.flush();
+        }
+
+    private:
+        void append_little_endian(uint64_t value, int bytes)
+        {
+            for (int i = 0; i < bytes; ++i)
+            {
+                m_buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        void write_buffer_if_full()
+        {
+            if (m_buffer.size() >= m_buffer_size)
+            {
+                write_buffer();
+            }
+        }
+
+        void write_buffer()
+        {
+            m_file.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+        }
+
+    private:
+        std::ofstream m_file;
+        size_t m_buffer_size;
+        std::chrono::steady_clock::time_point m_start;
+        std::mutex m_mutex;
+        std::vector<uint8_t> m_buffer;
+        uint32_t m_next_id = 0;
+        int64_t m_last_timestamp = 0;
+    };
+
+    // Logs every measurement it is given under its name in a binary_log_writer
+    class binary_log_monitor final : public timer_monitor
+    {
+    public:
+        binary_log_monitor(binary_log_writer& writer, std::string_view name)
+            : m_writer(writer)
+            , m_id(writer.register_monitor(name))
+        {
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            m_writer.record(m_id, duration);
+        }
+
+    private:
+        binary_log_writer& m_writer;
+        uint32_t m_id;
+    };
+
+    struct binary_log_record
+    {
+        uint32_t monitor_id;
+        // Points into the reader's mapping of the file
+        std::string_view monitor_name;
+        // Since the log's start time
+        std::chrono::nanoseconds timestamp;
+        std::chrono::nanoseconds duration;
+    };
+
+    // Maps a binary log into memory and iterates its measurements in file order, decoding them
+    // straight from the mapping without reading the file into buffers, so a log is read as fast
+    // as the OS can page it in. Names are views into the mapping and only valid while the
+    // reader is alive.
+    class binary_log_reader
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = binary_log_record;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const binary_log_record*;
+            using reference = const binary_log_record&;
+
+            iterator() = default;
+
+            reference operator*() const
+            {
+                return m_record;
+            }
+
+            pointer operator->() const
+            {
+                return &m_record;
+            }
+
+            iterator& operator++()
+            {
+                advance();
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto previous = *this;
+                advance();
+                return previous;
+            }
+
+            friend bool operator==(const iterator& a, const iterator& b)
+            {
+                return a.m_position == b.m_position;
+            }
+
+        private:
+            friend class binary_log_reader;
+
+            iterator(const uint8_t* position, const uint8_t* end) : m_position(position), m_end(end)
+            {
+                if (m_position != m_end)
+                {
+                    advance();
+                }
+            }
+
+            // Decodes up to and including the next measurement, skipping name records, or moves
+            // to the end if there is no complete measurement left
+            void advance()
+            {
+                const uint8_t* position = m_next;
+                if (position == nullptr)
+                {
+                    position = m_position;
+                }
+                while (position != m_end)
+                {
+                    const uint8_t* record_start = position;
+                    const uint8_t tag = *position++;
+                    uint64_t id;
+                    if (!detail::read_varint(position, m_end, id))
+                    {
+                        break;
+                    }
+                    if (tag == detail::binary_log_name_tag)
+                    {
+                        uint64_t length;
+                        if (!detail::read_varint(position, m_end, length) || length > static_cast<uint64_t>(m_end - position))
+                        {
+                            break;
+                        }
+                        // Ids are handed out in order, anything further on is corrupt and would
+                        // otherwise size the name table from an arbitrary varint
+                        if (id > m_names.size())
+                        {
+                            break;
+                        }
+                        if (id == m_names.size())
+                        {
+                            m_names.emplace_back();
+                        }
+                        m_names[id] = std::string_view(reinterpret_cast<const char*>(position), length);
+                        position += length;
+                    }
+                    else if (tag == detail::binary_log_measurement_tag)
+                    {
+                        uint64_t delta;
+                        uint64_t duration;
+                        if (!detail::read_varint(position, m_end, delta) || !detail::read_varint(position, m_end, duration))
+                        {
+                            break;
+                        }
+                        m_timestamp += static_cast<int64_t>(delta);
+                        m_record.monitor_id = static_cast<uint32_t>(id);
+                        m_record.monitor_name = id < m_names.size() ? m_names[id] : std::string_view();
+                        m_record.timestamp = std::chrono::nanoseconds(m_timestamp);
+                        m_record.duration = std::chrono::nanoseconds(detail::zigzag_decode(duration));
+                        m_position = record_start;
+                        m_next = position;
+                        return;
+                    }
+                    else
+                    {
+                        throw std::runtime_error("Error: Corrupt binary log, unknown record type " + std::to_string(tag) + ".");
+                    }
+                }
+                m_position = m_end;
+                m_next = m_end;
+            }
+
+        private:
+            // Start of the current measurement, m_end once finished
+            const uint8_t* m_position = nullptr;
+            // Just past the current measurement
+            const uint8_t* m_next = nullptr;
+            const uint8_t* m_end = nullptr;
+            int64_t m_timestamp = 0;
+            std::vector<std::string_view> m_names;
+            binary_log_record m_record{};
+        };
+
+        explicit binary_log_reader(const std::filesystem::path& file_path)
+        {
+            map(file_path);
+            if (m_size < detail::binary_log_header_size
+                || !std::equal(detail::binary_log_magic.begin(), detail::binary_log_magic.end(), reinterpret_cast<const char*>(m_data)))
+            {
+                unmap();
+                throw std::runtime_error("Error: " + file_path.string() + " is not a binary log.");
+            }
+            const uint32_t version = static_cast<uint32_t>(read_little_endian(8, 4));
+            if (version != detail::binary_log_version)
+            {
+                unmap();
+                throw std::runtime_error("Error: Unsupported binary log version " + std::to_string(version) + ".");
+            }
+        }
+
+        binary_log_reader(binary_log_reader&& other) noexcept
+            : m_data(std::exchange(other.m_data, nullptr))
+            , m_size(std::exchange(other.m_size, 0))
+        {
+        }
+
+        binary_log_reader& operator=(binary_log_reader&& other) noexcept
+        {
+            if (this != &other)
+            {
+                unmap();
+                m_data = std::exchange(other.m_data, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+            }
+            return *this;
+        }
+
+        binary_log_reader(const binary_log_reader&) = delete;
+        binary_log_reader& operator=(const binary_log_reader&) = delete;
+
+        ~binary_log_reader()
+        {
+            unmap();
+        }
+
+        [[nodiscard]] std::chrono::system_clock::time_point start_time() const
+        {
+            return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(static_cast<int64_t>(read_little_endian(16, 8)))));
+        }
+
+        // Size of the file in bytes
+        [[nodiscard]] size_t size() const
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] iterator begin() const
+        {
+            return iterator(m_data + detail::binary_log_header_size, m_data + m_size);
+        }
+
+        [[nodiscard]] iterator end() const
+        {
+            return iterator(m_data + m_size, m_data + m_size);
+        }
+
+    private:
+        [[nodiscard]] uint64_t read_little_endian(size_t offset, int bytes) const
+        {
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i)
+            {
+                value |= static_cast<uint64_t>(m_data[offset + i]) << (8 * i);
+            }
+            return value;
+        }
+
+        void map(const std::filesystem::path& file_path)
+        {
+            const auto mapped = detail::map_file(file_path);
+            if (mapped.data == nullptr)
+            {
+                throw std::runtime_error("Error: Unable to map binary log " + file_path.string() + ".");
+            }
+            m_data = mapped.data;
+            m_size = mapped.size;
+        }
+
+        void unmap()
+        {
+            detail::unmap_file({m_data, m_size});
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+    };
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sage::performance::detail
+{
+    // Fixed capacity lock-free multi producer, multi consumer queue (Dmitry Vyukov's bounded
+    // MPMC queue). Every cell carries a sequence number that tells producers and consumers
+    // whether it is free to write or ready to read, so neither side ever blocks the other.
+    // The capacity is rounded up to a power of two.
+    template <typename T>
+    class bounded_queue
+    {
+    public:
+        explicit bounded_queue(size_t capacity) : m_capacity(round_up_to_power_of_two(capacity)), m_mask(m_capacity - 1), m_cells(new cell[m_capacity])
+        {
+            for (size_t i = 0; i < m_capacity; ++i)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bounded_queue(const bounded_queue&) = delete;
+        bounded_queue& operator=(const bounded_queue&) = delete;
+
+        // Returns false without waiting if the queue is full
+        bool try_push(const T& value)
+        {
+            cell* c;
+            size_t position = m_enqueue_position.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                c = &m_cells[position & m_mask];
+                const size_t sequence = c->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0)
+                {
+                    if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+            c->value = value;
+            c->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Returns false without waiting if the queue is empty
+        bool try_pop(T& value)
+        {
+            cell* c;
+            size_t position = m_dequeue_position.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                c = &m_cells[position & m_mask];
+                const size_t sequence = c->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (difference == 0)
+                {
+                    if (m_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+            value = c->value;
+            c->sequence.store(position + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        // Total number of values ever pushed, counting pushes still being written
+        [[nodiscard]] size_t pushed() const
+        {
+            return m_enqueue_position.load(std::memory_order_acquire);
+        }
+
+        // Total number of values ever popped, counting pops still being read
+        [[nodiscard]] size_t popped() const
+        {
+            return m_dequeue_position.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct cell
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        static size_t round_up_to_power_of_two(size_t value)
+        {
+            size_t result = 2;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+    private:
+        size_t m_capacity;
+        size_t m_mask;
+        std::unique_ptr<cell[]> m_cells;
+        alignas(64) std::atomic<size_t> m_enqueue_position{0};
+        alignas(64) std::atomic<size_t> m_dequeue_position{0};
+    };
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "statistics.hpp"
+#include "timer.hpp"
+#include "timer_monitor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace sage::performance
+{
+    // What timing an empty scope costs, in nanoseconds
+    struct timer_overhead
+    {
+        // Duration an empty timed scope reports, the bias in every measurement. This is the time
+        // between the start and stop clock readings, so it includes part of the cost of reading
+        // the clock.
+        double median = 0.0;
+        double stddev = 0.0;
+        double min = 0.0;
+        // Wall time each empty timed scope adds to the code around it, including both clock
+        // readings and the monitor call
+        double cost = 0.0;
+        size_t samples = 0;
+
+        // e.g. timer overhead 18.00ns (stddev 2.10ns, min 15.00ns), 31.00ns per timed scope
+        [[nodiscard]] std::string s_summary() const
+        {
+            const auto time = [](double ns) {
+                return format_duration(std::chrono::duration<double, std::nano>(ns));
+            };
+            return "timer overhead " + time(median) + " (stddev " + time(stddev) + ", min " + time(min) + "), " + time(cost) + " per timed scope";
+        }
+    };
+
+    namespace detail
+    {
+        // Records into storage reserved up front, so calibration does not time the allocator
+        class calibration_monitor final : public timer_monitor
+        {
+        public:
+            explicit calibration_monitor(size_t capacity)
+            {
+                m_measurements.reserve(capacity);
+            }
+
+            void add_measurement(std::chrono::nanoseconds duration) override
+            {
+                if (m_measurements.size() < m_measurements.capacity())
+                {
+                    m_measurements.push_back(static_cast<double>(duration.count()));
+                }
+            }
+
+            [[nodiscard]] const std::vector<double>& measurements() const
+            {
+                return m_measurements;
+            }
+
+            void clear()
+            {
+                m_measurements.clear();
+            }
+
+        private:
+            std::vector<double> m_measurements;
+        };
+    }
+
+    namespace detail
+    {
+        // What basic_timer does for an empty scope, written out so calibration still measures
+        // the clock when timers are compiled out with SAGE_PERFORMANCE_DISABLE. The benchmark
+        // harness times its batches with the same two readings.
+        template <typename ClockT>
+        void time_empty_scope(timer_monitor& monitor)
+        {
+            const auto start_time_point = start_now<ClockT>();
+            const auto end_time_point = stop_now<ClockT>();
+            monitor.add_measurement(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_point - start_time_point));
+        }
+    }
+
+    // Times an empty scope, the same way basic_timer<ClockT> does, many times after a short
+    // warm up to find the overhead timing adds to every measurement. Run it on an otherwise
+    // idle thread, and again if the clock source or CPU frequency changes.
+    template <typename ClockT = std::chrono::steady_clock>
+    timer_overhead calibrate_timer_overhead(size_t samples = 10000)
+    {
+        detail::calibration_monitor monitor(samples);
+        for (size_t i = 0; i < std::min<size_t>(samples, 1000); ++i)
+        {
+            detail::time_empty_scope<ClockT>(monitor);
+        }
+        monitor.clear();
+
+        const auto start = detail::start_now<ClockT>();
+        for (size_t i = 0; i < samples; ++i)
+        {
+            detail::time_empty_scope<ClockT>(monitor);
+        }
+        const auto end = detail::stop_now<ClockT>();
+
+        const auto& measurements = monitor.measurements();
+        if (measurements.empty())
+        {
+            return {};
+        }
+        timer_overhead overhead;
+        overhead.median = statistics::median(measurements);
+        overhead.stddev = statistics::stddev(measurements);
+        overhead.min = statistics::min(measurements);
+        overhead.cost = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(measurements.size());
+        overhead.samples = measurements.size();
+        return overhead;
+    }
+
+    // Overhead of basic_timer<ClockT>, calibrated the first time it is asked for
+    template <typename ClockT = std::chrono::steady_clock>
+    const timer_overhead& calibrated_timer_overhead()
+    {
+        static const timer_overhead overhead = calibrate_timer_overhead<ClockT>();
+        return overhead;
+    }
+
+    // Adaptor that takes the timer overhead off each measurement before passing it on, so short
+    // scopes are not dominated by the cost of timing them. Corrected measurements are clamped
+    // at zero, as scopes shorter than the overhead noise can come out negative.
+    class overhead_corrected_monitor final : public timer_monitor
+    {
+    public:
+        overhead_corrected_monitor(timer_monitor& monitor, const timer_overhead& overhead = calibrated_timer_overhead())
+            : m_monitor(monitor)
+            , m_overhead(static_cast<std::chrono::nanoseconds::rep>(std::llround(overhead.median)))
+        {
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            m_monitor.add_measurement(std::max(duration - m_overhead, std::chrono::nanoseconds(0)));
+        }
+
+        [[nodiscard]] std::chrono::nanoseconds overhead() const
+        {
+            return m_overhead;
+        }
+
+    private:
+        timer_monitor& m_monitor;
+        std::chrono::nanoseconds m_overhead;
+    };
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "sage/term/colours.hpp"
+
+#include "binary_log.hpp"
+#include "monitors.hpp"
+#include "statistics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sage::performance
+{
+    // Measurements in nanoseconds, by benchmark or monitor name
+    using measurement_sets = std::map<std::string, std::vector<double>>;
+
+    // Loads measurements from any of
+    //   - benchmark runner CSV output (name,repetition,iterations,ns_per_iteration), one set per
+    //     benchmark
+    //   - a binary log (see binary_log.hpp), one set per monitor
+    //   - text with one measurement in milliseconds per line, as printed from
+    //     performance_monitor::get_measurements(), one set named text_set_name so that dumps
+    //     from two runs line up whatever the files are called
+    inline measurement_sets load_measurements(const std::filesystem::path& file_path, const std::string& text_set_name = "measurements")
+    {
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Error: Unable to open " + file_path.string() + " for reading.");
+        }
+
+        std::array<char, 8> magic{};
+        file.read(magic.data(), magic.size());
+        if (file.gcount() == static_cast<std::streamsize>(magic.size()) && magic == detail::binary_log_magic)
+        {
+            file.close();
+            measurement_sets sets;
+            binary_log_reader reader(file_path);
+            for (const auto& record : reader)
+            {
+                sets[std::string(record.monitor_name)].push_back(static_cast<double>(record.duration.count()));
+            }
+            return sets;
+        }
+        file.clear();
+        file.seekg(0);
+
+        measurement_sets sets;
+        std::string line;
+        size_t line_number = 0;
+        bool is_csv = false;
+        while (std::getline(file, line))
+        {
+            ++line_number;
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (line.empty())
+            {
+                continue;
+            }
+            if (line_number == 1 && line.starts_with("name,"))
+            {
+                is_csv = true;
+                continue;
+            }
+            try
+            {
+                if (is_csv)
+                {
+                    // The name may itself contain commas, the value is after the last one
+                    const auto last_comma = line.rfind(',');
+                    if (last_comma == std::string::npos || last_comma == 0)
+                    {
+                        throw std::invalid_argument("missing columns");
+                    }
+                    const auto iterations_comma = line.rfind(',', last_comma - 1);
+                    const auto repetition_comma = iterations_comma == std::string::npos ? std::string::npos : line.rfind(',', iterations_comma - 1);
+                    if (repetition_comma == std::string::npos)
+                    {
+                        throw std::invalid_argument("missing columns");
+                    }
+                    sets[line.substr(0, repetition_comma)].push_back(std::stod(line.substr(last_comma + 1)));
+                }
+                else
+                {
+                    sets[text_set_name].push_back(std::stod(line) * 1e6);
+                }
+            }
+            catch (const std::exception&)
+            {
+                throw std::runtime_error("Error: Unable to parse line " + std::to_string(line_number) + " of " + file_path.string() + ".");
+            }
+        }
+        return sets;
+    }
+
+    struct compare_options
+    {
+        // Significance level of the Mann-Whitney U test
+        double alpha = 0.05;
+        // Smallest relative change of the median reported as faster or slower, e.g. 0.02 for 2%
+        double threshold = 0.0;
+        // Confidence level of the speedup interval
+        double confidence = 0.95;
+        size_t resamples = 2000;
+    };
+
+    enum class comparison_verdict
+    {
+        unchanged,
+        faster,
+        slower,
+        only_in_baseline,
+        only_in_candidate
+    };
+
+    struct comparison_result
+    {
+        std::string name;
+        // Medians in nanoseconds
+        double baseline_median = 0.0;
+        double candidate_median = 0.0;
+        // baseline median / candidate median, above 1 when the candidate is faster
+        double speedup = 0.0;
+        statistics::confidence_interval speedup_interval{};
+        double p_value = 0.0;
+        comparison_verdict verdict = comparison_verdict::unchanged;
+    };
+
+    // A change is only faster or slower if the U test finds the two sets differ at the alpha
+    // level and the medians differ by more than the threshold
+    inline comparison_result compare_measurements(const std::string& name,
+                                                  const std::vector<double>& baseline,
+                                                  const std::vector<double>& candidate,
+                                                  const compare_options& options = {})
+    {
+        comparison_result result;
+        result.name = name;
+        result.baseline_median = statistics::median(baseline);
+        result.candidate_median = statistics::median(candidate);
+        if (baseline.empty() || candidate.empty())
+        {
+            result.verdict = baseline.empty() ? comparison_verdict::only_in_candidate : comparison_verdict::only_in_baseline;
+            return result;
+        }
+
+        result.speedup = result.baseline_median / result.candidate_median;
+        result.speedup_interval = statistics::bootstrap_median_ratio(baseline, candidate, options.confidence, options.resamples);
+        result.p_value = statistics::mann_whitney_u(baseline, candidate).p_value;
+        if (result.p_value < options.alpha)
+        {
+            if (result.candidate_median > result.baseline_median * (1.0 + options.threshold))
+            {
+                result.verdict = comparison_verdict::slower;
+            }
+            else if (result.candidate_median < result.baseline_median * (1.0 - options.threshold))
+            {
+                result.verdict = comparison_verdict::faster;
+            }
+        }
+        return result;
+    }
+
+    // Compares every name in either set, in name order
+    inline std::vector<comparison_result> compare_measurements(const measurement_sets& baseline,
+                                                               const measurement_sets& candidate,
+                                                               const compare_options& options = {})
+    {
+        std::map<std::string, std::pair<const std::vector<double>*, const std::vector<double>*>> names;
+        for (const auto& [name, samples] : baseline)
+        {
+            names[name].first = &samples;
+        }
+        for (const auto& [name, samples] : candidate)
+        {
+            names[name].second = &samples;
+        }
+
+        const std::vector<double> none;
+        std::vector<comparison_result> results;
+        for (const auto& [name, sets] : names)
+        {
+            results.push_back(compare_measurements(name, sets.first ? *sets.first : none, sets.second ? *sets.second : none, options));
+        }
+        return results;
+    }
+
+    // Whether any name was in both sets, i.e. anything was actually compared
+    inline bool any_compared(const std::vector<comparison_result>& results)
+    {
+        return std::any_of(results.begin(), results.end(), [](const comparison_result& result) {
+            return result.verdict != comparison_verdict::only_in_baseline && result.verdict != comparison_verdict::only_in_candidate;
+        });
+    }
+
+    inline void write_comparison_table(std::ostream& stream, const std::vector<comparison_result>& results, bool colour = true)
+    {
+        const auto time = [](double ns) {
+            return format_duration(std::chrono::duration<double, std::nano>(ns));
+        };
+        const auto fixed = [](double value, int precision) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(precision) << value;
+            return text.str();
+        };
+
+        stream << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "baseline" << std::setw(14) << "candidate"
+               << std::setw(10) << "speedup" << std::setw(20) << "interval" << std::setw(10) << "p" << "  result" << std::endl;
+        for (const auto& result : results)
+        {
+            stream << std::left << std::setw(40) << result.name << std::right;
+            if (result.verdict == comparison_verdict::only_in_baseline || result.verdict == comparison_verdict::only_in_candidate)
+            {
+                const bool in_baseline = result.verdict == comparison_verdict::only_in_baseline;
+                stream << std::setw(14) << (in_baseline ? time(result.baseline_median) : "-")
+                       << std::setw(14) << (in_baseline ? "-" : time(result.candidate_median))
+                       << std::setw(10) << "" << std::setw(20) << "" << std::setw(10) << ""
+                       << (in_baseline ? "  only in baseline" : "  only in candidate") << std::endl;
+                continue;
+            }
+
+            stream << std::setw(14) << time(result.baseline_median) << std::setw(14) << time(result.candidate_median)
+                   << std::setw(10) << (fixed(result.speedup, 3) + "x")
+                   << std::setw(20) << ("[" + fixed(result.speedup_interval.lower, 3) + ", " + fixed(result.speedup_interval.upper, 3) + "]")
+                   << std::setw(10) << fixed(result.p_value, 4) << "  ";
+            if (result.verdict == comparison_verdict::unchanged)
+            {
+                stream << "unchanged" << std::endl;
+                continue;
+            }
+            const bool faster = result.verdict == comparison_verdict::faster;
+            if (colour)
+            {
+                stream << term::f(faster ? term::fg::GREEN : term::fg::RED);
+            }
+            stream << (faster ? "faster" : "SLOWER");
+            if (colour)
+            {
+                stream << term::f(term::RESET);
+            }
+            stream << std::endl;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "timer.hpp"
+#include "timer_monitor.hpp"
+
+#include <chrono>
+#include <concepts>
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace sage::performance
+{
+    // Anything that can stop and restart counting time, such as basic_timer
+    template <typename TimerT>
+    concept pausable_timer = requires(TimerT& timer) {
+        timer.pause();
+        timer.resume();
+    };
+
+    namespace detail
+    {
+        // The awaiter a co_await expression would use for the awaitable, from its member or free
+        // operator co_await, otherwise the awaitable itself
+        template <typename AwaitableT>
+        decltype(auto) get_awaiter(AwaitableT&& awaitable)
+        {
+            if constexpr (requires { static_cast<AwaitableT&&>(awaitable).operator co_await(); })
+            {
+                return static_cast<AwaitableT&&>(awaitable).operator co_await();
+            }
+            else if constexpr (requires { operator co_await(static_cast<AwaitableT&&>(awaitable)); })
+            {
+                return operator co_await(static_cast<AwaitableT&&>(awaitable));
+            }
+            else
+            {
+                return static_cast<AwaitableT&&>(awaitable);
+            }
+        }
+
+        // Awaiters returned by reference are kept by reference, anything else is kept by value
+        template <typename AwaitableT>
+        using awaiter_storage_t = std::conditional_t<std::is_lvalue_reference_v<decltype(get_awaiter(std::declval<AwaitableT>()))>,
+                                                     decltype(get_awaiter(std::declval<AwaitableT>())),
+                                                     std::remove_cvref_t<decltype(get_awaiter(std::declval<AwaitableT>()))>>;
+    }
+
+    // Awaiter that pauses a timer while the awaiting coroutine is suspended. The timer is paused
+    // just before the wrapped awaiter's await_suspend, and resumed in await_resume, which runs on
+    // whichever thread resumes the coroutine. Nothing is touched after the wrapped await_suspend
+    // returns, as by then the coroutine may already be running elsewhere.
+    template <pausable_timer TimerT, typename AwaitableT>
+    class paused_awaiter
+    {
+    public:
+        paused_awaiter(TimerT* timer, AwaitableT&& awaitable)
+            : m_timer(timer)
+            , m_awaiter(detail::get_awaiter(std::forward<AwaitableT>(awaitable)))
+        {
+        }
+
+        bool await_ready()
+        {
+            return m_awaiter.await_ready();
+        }
+
+        template <typename PromiseT>
+        decltype(auto) await_suspend(std::coroutine_handle<PromiseT> handle)
+        {
+            if (m_timer != nullptr)
+            {
+                m_timer->pause();
+            }
+            // If this does not suspend after all (returns false, or the handle it was given)
+            // await_resume restarts the timer
+            return m_awaiter.await_suspend(handle);
+        }
+
+        decltype(auto) await_resume()
+        {
+            if (m_timer != nullptr)
+            {
+                m_timer->resume();
+            }
+            return m_awaiter.await_resume();
+        }
+
+    private:
+        TimerT* m_timer;
+        detail::awaiter_storage_t<AwaitableT> m_awaiter;
+    };
+
+    // Wraps an awaitable so the timer does not count the time the coroutine spends suspended on
+    // it, e.g.
+    //     co_await paused_while(t, socket.read(buffer));
+    // The result refers to the awaitable if it is an lvalue, so it is meant to be awaited in the
+    // same expression it is created in.
+    template <pausable_timer TimerT, typename AwaitableT>
+    paused_awaiter<TimerT, AwaitableT> paused_while(TimerT& timer, AwaitableT&& awaitable)
+    {
+        return paused_awaiter<TimerT, AwaitableT>(&timer, std::forward<AwaitableT>(awaitable));
+    }
+
+    // As above, nothing is paused when the timer is null
+    template <pausable_timer TimerT, typename AwaitableT>
+    paused_awaiter<TimerT, AwaitableT> paused_while(TimerT* timer, AwaitableT&& awaitable)
+    {
+        return paused_awaiter<TimerT, AwaitableT>(timer, std::forward<AwaitableT>(awaitable));
+    }
+
+    // Mixin for coroutine promise types that times how long the coroutine actually runs on a
+    // thread, leaving out every suspension. Derive the promise from it, and either take a
+    // timer_monitor& (or any basic_timer_monitor) as a coroutine argument, which starts timing
+    // when the coroutine is created, or call start_timing() from the promise. Every co_await in
+    // the coroutine is wrapped by await_transform, so a promise that defines its own
+    // await_transform should pass the awaitable through paused() as well.
+    //
+    // initial_suspend and final_suspend do not go through await_transform. A lazily started
+    // coroutine should return paused(std::suspend_always{}) from initial_suspend so the wait
+    // until it is first resumed is not counted, and final_suspend should call stop_timing() so
+    // the measurement is reported when the coroutine finishes rather than when its frame is
+    // destroyed.
+    //
+    // Each running period starts and stops on the same thread, so thread_cpu_clock gives the
+    // CPU time of the coroutine even if it is resumed on different threads.
+    template <typename ClockT = std::chrono::steady_clock, typename DurationT = std::chrono::nanoseconds>
+    class basic_timed_promise
+    {
+    public:
+        using timer_t = basic_timer<ClockT, DurationT>;
+        using monitor_t = typename timer_t::monitor_t;
+
+        basic_timed_promise() = default;
+
+        // Picks up the first monitor among the coroutine's arguments
+        template <typename... ArgsT>
+        explicit basic_timed_promise(ArgsT&... args)
+        {
+            (start_from(args), ...);
+        }
+
+        void start_timing(monitor_t& monitor)
+        {
+            m_timer.emplace(monitor);
+        }
+
+        // Reports the time the coroutine has run for so far, later suspensions are not timed
+        void stop_timing()
+        {
+            m_timer.reset();
+        }
+
+        // Discards the measurement
+        void cancel_timing() noexcept
+        {
+            if (m_timer)
+            {
+                m_timer->cancel();
+            }
+        }
+
+        template <typename AwaitableT>
+        paused_awaiter<timer_t, AwaitableT> paused(AwaitableT&& awaitable)
+        {
+            return paused_while(m_timer ? &*m_timer : nullptr, std::forward<AwaitableT>(awaitable));
+        }
+
+        template <typename AwaitableT>
+        paused_awaiter<timer_t, AwaitableT> await_transform(AwaitableT&& awaitable)
+        {
+            return paused(std::forward<AwaitableT>(awaitable));
+        }
+
+    private:
+        template <typename ArgT>
+        void start_from(ArgT& arg)
+        {
+            if constexpr (std::derived_from<ArgT, monitor_t>)
+            {
+                if (!m_timer)
+                {
+                    start_timing(arg);
+                }
+            }
+        }
+
+    private:
+        std::optional<timer_t> m_timer;
+    };
+
+    using timed_promise = basic_timed_promise<>;
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "timer.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define SAGE_PERFORMANCE_HAS_PERF_EVENTS 1
+#else
+#define SAGE_PERFORMANCE_HAS_PERF_EVENTS 0
+#endif
+
+namespace sage::performance
+{
+    // Hardware counter deltas over a timed scope. available is false when the counters could
+    // not be opened, the counts are then all zero and only the duration is meaningful.
+    struct counter_values
+    {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t cache_misses = 0;
+        uint64_t branch_misses = 0;
+        bool available = false;
+
+        [[nodiscard]] double instructions_per_cycle() const
+        {
+            return cycles == 0 ? 0.0 : static_cast<double>(instructions) / static_cast<double>(cycles);
+        }
+
+        counter_values& operator+=(const counter_values& other)
+        {
+            cycles += other.cycles;
+            instructions += other.instructions;
+            cache_misses += other.cache_misses;
+            branch_misses += other.branch_misses;
+            available = available || other.available;
+            return *this;
+        }
+
+        friend counter_values operator-(const counter_values& end, const counter_values& start)
+        {
+            return {end.cycles - start.cycles,
+                    end.instructions - start.instructions,
+                    end.cache_misses - start.cache_misses,
+                    end.branch_misses - start.branch_misses,
+                    end.available && start.available};
+        }
+    };
+
+    // Interface for monitors that take hardware counter deltas alongside the duration
+    class counter_monitor
+    {
+    public:
+        virtual ~counter_monitor() = default;
+        virtual void add_measurement(std::chrono::nanoseconds duration, const counter_values& counters) = 0;
+    };
+
+    // The calling thread's group of hardware counters (cycles, instructions, cache misses and
+    // branch misses), opened with perf_event_open the first time the thread uses it and closed
+    // when the thread exits. The counters only count user space code of the thread and are
+    // opened as one group, so the kernel always schedules them together and their values are
+    // read in a single call. If the group can not be opened (non Linux targets, no PMU access
+    // in a VM, or kernel.perf_event_paranoid too strict) available() is false and read()
+    // returns zeros.
+    class perf_counter_group
+    {
+    public:
+        static perf_counter_group& local()
+        {
+            thread_local perf_counter_group group;
+            return group;
+        }
+
+        perf_counter_group(const perf_counter_group&) = delete;
+        perf_counter_group& operator=(const perf_counter_group&) = delete;
+
+        ~perf_counter_group()
+        {
+            close_all();
+        }
+
+        [[nodiscard]] bool available() const
+        {
+            return m_available;
+        }
+
+        // Current counts since the group was opened
+        [[nodiscard]] counter_values read() const
+        {
+#if SAGE_PERFORMANCE_HAS_PERF_EVENTS
+            if (m_available)
+            {
+                // PERF_FORMAT_GROUP layout: number of counters followed by their values
+                std::array<uint64_t, 1 + counter_count> buffer{};
+                if (::read(m_fds[0], buffer.data(), sizeof(buffer)) == static_cast<ssize_t>(sizeof(buffer)))
+                {
+                    return {buffer[1], buffer[2], buffer[3], buffer[4], true};
+                }
+            }
+#endif
+            return {};
+        }
+
+    private:
+        static constexpr size_t counter_count = 4;
+
+        perf_counter_group()
+        {
+            m_fds.fill(-1);
+#if SAGE_PERFORMANCE_HAS_PERF_EVENTS
+            constexpr std::array<uint64_t, counter_count> configs = {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES,
+                PERF_COUNT_HW_BRANCH_MISSES
+            };
+            for (size_t i = 0; i < counter_count; ++i)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = configs[i];
+                attr.read_format = PERF_FORMAT_GROUP;
+                attr.disabled = i == 0 ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                m_fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : m_fds[0], 0));
+                if (m_fds[i] < 0)
+                {
+                    close_all();
+                    return;
+                }
+            }
+            ::ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            m_available = ::ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == 0;
+            if (!m_available)
+            {
+                close_all();
+            }
+#endif
+        }
+
+        void close_all()
+        {
+#if SAGE_PERFORMANCE_HAS_PERF_EVENTS
+            // Members are closed before the leader
+            for (size_t i = counter_count; i-- > 0;)
+            {
+                if (m_fds[i] >= 0)
+                {
+                    ::close(m_fds[i]);
+                    m_fds[i] = -1;
+                }
+            }
+#endif
+            m_available = false;
+        }
+
+    private:
+        std::array<int, counter_count> m_fds{};
+        bool m_available = false;
+    };
+
+    // Totals the durations and counter deltas it is given
+    class counter_summary_monitor final : public counter_monitor
+    {
+    public:
+        void add_measurement(std::chrono::nanoseconds duration, const counter_values& counters) override
+        {
+            ++m_count;
+            m_total += duration;
+            m_counters += counters;
+        }
+
+        [[nodiscard]] size_t count() const
+        {
+            return m_count;
+        }
+
+        // Total in milliseconds
+        [[nodiscard]] double total() const
+        {
+            return fractional_milliseconds(m_total).count();
+        }
+
+        // Average in milliseconds
+        [[nodiscard]] double average() const
+        {
+            return total() / static_cast<double>(m_count);
+        }
+
+        // Summed counter deltas, available is false if no measurement had counters
+        [[nodiscard]] const counter_values& counters() const
+        {
+            return m_counters;
+        }
+
+        [[nodiscard]] double instructions_per_cycle() const
+        {
+            return m_counters.instructions_per_cycle();
+        }
+
+        [[nodiscard]] std::string s_total() const
+        {
+            return format_time(total());
+        }
+
+        [[nodiscard]] std::string s_average() const
+        {
+            return format_time(average());
+        }
+
+    private:
+        size_t m_count = 0;
+        std::chrono::nanoseconds m_total{0};
+        counter_values m_counters;
+    };
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, the timer holds no state and does nothing
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_counter_timer
+    {
+    public:
+        explicit basic_counter_timer(counter_monitor&) noexcept
+        {
+        }
+
+        basic_counter_timer(const basic_counter_timer&) = delete;
+        basic_counter_timer& operator=(const basic_counter_timer&) = delete;
+    };
+#else
+    // RAII timer that also reads the calling thread's hardware counters at the start and end
+    // of the scope and reports the deltas. The counters are read inside the clock reads, so
+    // the time includes the cost of reading them (a read syscall each, around a microsecond)
+    // but the counts mostly do not. Falls back to timing only where the counters are not
+    // available.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_counter_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit basic_counter_timer(counter_monitor& monitor) : m_monitor(monitor), m_group(perf_counter_group::local())
+        {
+            m_start_time_point = detail::start_now<clock_t>();
+            m_start_counters = m_group.read();
+        }
+
+        ~basic_counter_timer()
+        {
+            const auto end_counters = m_group.read();
+            const auto end_time_point = detail::stop_now<clock_t>();
+            m_monitor.add_measurement(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_point - m_start_time_point), end_counters - m_start_counters);
+        }
+
+        basic_counter_timer(const basic_counter_timer&) = delete;
+        basic_counter_timer& operator=(const basic_counter_timer&) = delete;
+
+    private:
+        counter_monitor& m_monitor;
+        const perf_counter_group& m_group;
+        time_point_t m_start_time_point;
+        counter_values m_start_counters;
+    };
+#endif
+
+    using counter_timer = basic_counter_timer<>;
+}
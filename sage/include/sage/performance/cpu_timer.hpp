@@ -0,0 +1,213 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "platform.hpp"
+#include "timer.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace sage::performance
+{
+    // Clock that only advances while the calling thread runs on a CPU, in user or kernel
+    // mode, so time spent blocked on a lock, sleeping or waiting for I/O is not counted.
+    // Readings from different threads are unrelated, a timer must start and stop on the same
+    // thread.
+    class thread_cpu_clock
+    {
+    public:
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::nanoseconds;
+        using time_point = std::chrono::time_point<thread_cpu_clock>;
+        static constexpr bool is_steady = false;
+
+        static time_point now() noexcept
+        {
+            return time_point(detail::thread_cpu_time());
+        }
+    };
+
+    // Clock that advances with the CPU time of every thread in the process, so it can run faster
+    // than wall time when several threads are busy
+    class process_cpu_clock
+    {
+    public:
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::nanoseconds;
+        using time_point = std::chrono::time_point<process_cpu_clock>;
+        static constexpr bool is_steady = false;
+
+        static time_point now() noexcept
+        {
+            return time_point(detail::process_cpu_time());
+        }
+    };
+
+    using thread_cpu_timer = basic_timer<thread_cpu_clock>;
+    using process_cpu_timer = basic_timer<process_cpu_clock>;
+
+    // Whose CPU time a cpu_timer measures
+    enum class cpu_scope
+    {
+        // The calling thread, falls back to the process where the platform can not tell
+        // threads apart
+        thread,
+        process
+    };
+
+    // Wall time of a scope with the CPU time spent in it, split into user and system (kernel)
+    // time. CPU time well below wall time means the scope was waiting, on a lock, I/O or the
+    // scheduler, rather than computing.
+    struct cpu_times
+    {
+        std::chrono::nanoseconds wall{0};
+        std::chrono::nanoseconds user{0};
+        std::chrono::nanoseconds system{0};
+
+        [[nodiscard]] std::chrono::nanoseconds cpu() const
+        {
+            return user + system;
+        }
+
+        cpu_times& operator+=(const cpu_times& other)
+        {
+            wall += other.wall;
+            user += other.user;
+            system += other.system;
+            return *this;
+        }
+    };
+
+    // Interface for monitors that take the wall and CPU times of a scope
+    class cpu_monitor
+    {
+    public:
+        virtual ~cpu_monitor() = default;
+        virtual void add_measurement(const cpu_times& times) = 0;
+    };
+
+    // Totals the wall and CPU times it is given
+    class cpu_summary_monitor final : public cpu_monitor
+    {
+    public:
+        void add_measurement(const cpu_times& times) override
+        {
+            ++m_count;
+            m_totals += times;
+        }
+
+        [[nodiscard]] size_t count() const
+        {
+            return m_count;
+        }
+
+        [[nodiscard]] const cpu_times& totals() const
+        {
+            return m_totals;
+        }
+
+        // Fraction of the wall time spent on a CPU, above 1 for process scopes running several
+        // busy threads
+        [[nodiscard]] double cpu_utilisation() const
+        {
+            return m_totals.wall.count() == 0 ? 0.0 : static_cast<double>(m_totals.cpu().count()) / static_cast<double>(m_totals.wall.count());
+        }
+
+        // Totals in milliseconds
+        [[nodiscard]] double total_wall() const
+        {
+            return fractional_milliseconds(m_totals.wall).count();
+        }
+
+        [[nodiscard]] double total_user() const
+        {
+            return fractional_milliseconds(m_totals.user).count();
+        }
+
+        [[nodiscard]] double total_system() const
+        {
+            return fractional_milliseconds(m_totals.system).count();
+        }
+
+        [[nodiscard]] std::string s_summary() const
+        {
+            return "wall " + format_time(total_wall()) + ", user " + format_time(total_user()) + ", system " + format_time(total_system());
+        }
+
+    private:
+        size_t m_count = 0;
+        cpu_times m_totals;
+    };
+
+    namespace detail
+    {
+        // User and system CPU time used so far, wall is left at zero
+        inline cpu_times cpu_usage(cpu_scope scope) noexcept
+        {
+            const auto usage = scope == cpu_scope::thread ? thread_cpu_usage() : process_cpu_usage();
+            cpu_times times;
+            times.user = usage.user;
+            times.system = usage.system;
+            return times;
+        }
+    }
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, the timer holds no state and does nothing
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_cpu_timer
+    {
+    public:
+        explicit basic_cpu_timer(cpu_monitor&, cpu_scope = cpu_scope::thread) noexcept
+        {
+        }
+
+        basic_cpu_timer(const basic_cpu_timer&) = delete;
+        basic_cpu_timer& operator=(const basic_cpu_timer&) = delete;
+    };
+#else
+    // RAII timer that reports the wall time of its scope together with the user and system CPU
+    // time used by the calling thread (or the whole process) in it, from getrusage, or
+    // GetThreadTimes / GetProcessTimes on Windows. CPU times have microsecond resolution at
+    // best, and some platforms only update them on scheduler ticks, so they suit scopes of a
+    // millisecond or more.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_cpu_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit basic_cpu_timer(cpu_monitor& monitor, cpu_scope scope = cpu_scope::thread)
+            : m_monitor(monitor)
+            , m_scope(scope)
+        {
+            m_start_usage = detail::cpu_usage(m_scope);
+            m_start_time_point = detail::start_now<clock_t>();
+        }
+
+        ~basic_cpu_timer()
+        {
+            const auto end_time_point = detail::stop_now<clock_t>();
+            const auto end_usage = detail::cpu_usage(m_scope);
+            m_monitor.add_measurement({std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_point - m_start_time_point),
+                                       end_usage.user - m_start_usage.user,
+                                       end_usage.system - m_start_usage.system});
+        }
+
+        basic_cpu_timer(const basic_cpu_timer&) = delete;
+        basic_cpu_timer& operator=(const basic_cpu_timer&) = delete;
+
+    private:
+        cpu_monitor& m_monitor;
+        cpu_scope m_scope;
+        cpu_times m_start_usage;
+        time_point_t m_start_time_point;
+    };
+#endif
+
+    using cpu_timer = basic_cpu_timer<>;
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "monitors.hpp"
+
+namespace sage::performance
+{
+    // Log bucketed histogram in the style of HdrHistogram. Values are counted in buckets whose
+    // width grows with the magnitude of the value, so every recorded value is kept to within
+    // the requested number of significant decimal digits, while memory is fixed up front by
+    // the trackable range. Recording is a couple of bit operations and an increment, and
+    // percentile queries scan the fixed number of buckets so their cost does not depend on how
+    // many measurements have been recorded. Values outside the trackable range are clamped
+    // to it, the exact min and max are kept alongside the buckets.
+    class histogram_monitor final : public timer_monitor
+    {
+    public:
+        explicit histogram_monitor(std::chrono::nanoseconds lowest_discernible = std::chrono::microseconds(1),
+                                   std::chrono::nanoseconds highest_trackable = std::chrono::minutes(1),
+                                   int significant_digits = 3)
+            : m_lowest_discernible(lowest_discernible.count())
+            , m_highest_trackable(highest_trackable.count())
+            , m_significant_digits(significant_digits)
+        {
+            if (m_lowest_discernible < 1)
+            {
+                throw std::invalid_argument("Error: Histogram lowest discernible value must be at least 1ns.");
+            }
+            if (m_highest_trackable < 2 * m_lowest_discernible)
+            {
+                throw std::invalid_argument("Error: Histogram highest trackable value must be at least twice the lowest discernible value.");
+            }
+            if (m_significant_digits < 1 || m_significant_digits > 5)
+            {
+                throw std::invalid_argument("Error: Histogram significant digits must be between 1 and 5.");
+            }
+
+            int64_t largest_value_with_single_unit_resolution = 2;
+            for (int i = 0; i < m_significant_digits; ++i)
+            {
+                largest_value_with_single_unit_resolution *= 10;
+            }
+
+            m_unit_magnitude = static_cast<int>(std::bit_width(static_cast<uint64_t>(m_lowest_discernible))) - 1;
+            const auto sub_bucket_count_magnitude = static_cast<int>(std::bit_width(static_cast<uint64_t>(largest_value_with_single_unit_resolution - 1)));
+            m_sub_bucket_half_count_magnitude = std::max(sub_bucket_count_magnitude, 1) - 1;
+            m_sub_bucket_count = int64_t(1) << (m_sub_bucket_half_count_magnitude + 1);
+            m_sub_bucket_half_count = m_sub_bucket_count / 2;
+            m_sub_bucket_mask = (m_sub_bucket_count - 1) << m_unit_magnitude;
+
+            int64_t smallest_untrackable_value = m_sub_bucket_count << m_unit_magnitude;
+            int bucket_count = 1;
+            while (smallest_untrackable_value <= m_highest_trackable)
+            {
+                if (smallest_untrackable_value > std::numeric_limits<int64_t>::max() / 2)
+                {
+                    ++bucket_count;
+                    break;
+                }
+                smallest_untrackable_value <<= 1;
+                ++bucket_count;
+            }
+            m_counts.assign(static_cast<size_t>(bucket_count + 1) * static_cast<size_t>(m_sub_bucket_half_count), 0);
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            const int64_t value = std::clamp<int64_t>(duration.count(), 0, m_highest_trackable);
+            ++m_counts[counts_index_for(value)];
+            ++m_total_count;
+            m_total += value;
+            m_min = std::min(m_min, value);
+            m_max = std::max(m_max, value);
+        }
+
+        // Combines the counts of another histogram, both must have been created with the same
+        // range and precision
+        void merge(const histogram_monitor& other)
+        {
+            if (m_lowest_discernible != other.m_lowest_discernible
+                || m_highest_trackable != other.m_highest_trackable
+                || m_significant_digits != other.m_significant_digits)
+            {
+                throw std::invalid_argument("Error: Can only merge histograms with the same range and significant digits.");
+            }
+            for (size_t i = 0; i < m_counts.size(); ++i)
+            {
+                m_counts[i] += other.m_counts[i];
+            }
+            m_total_count += other.m_total_count;
+            m_total += other.m_total;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        void reset()
+        {
+            std::fill(m_counts.begin(), m_counts.end(), 0);
+            m_total_count = 0;
+            m_total = 0;
+            m_min = std::numeric_limits<int64_t>::max();
+            m_max = 0;
+        }
+
+        [[nodiscard]] uint64_t count() const {
+            return m_total_count;
+        }
+
+        // Statistics in milliseconds, NaN until a measurement has been added
+        [[nodiscard]] double value_at_percentile(double percentile) const
+        {
+            if (m_total_count == 0)
+            {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            const double requested = std::clamp(percentile, 0.0, 100.0);
+            const auto count_at_percentile = std::max<uint64_t>(1, static_cast<uint64_t>(requested / 100.0 * static_cast<double>(m_total_count) + 0.5));
+
+            uint64_t running_count = 0;
+            for (size_t i = 0; i < m_counts.size(); ++i)
+            {
+                running_count += m_counts[i];
+                if (running_count >= count_at_percentile)
+                {
+                    const int64_t value = highest_equivalent_value(value_at_index(i));
+                    return to_milliseconds(std::clamp(value, m_min, m_max));
+                }
+            }
+            return to_milliseconds(m_max);
+        }
+
+        [[nodiscard]] double p50() const {
+            return value_at_percentile(50.0);
+        }
+
+        [[nodiscard]] double p90() const {
+            return value_at_percentile(90.0);
+        }
+
+        [[nodiscard]] double p99() const {
+            return value_at_percentile(99.0);
+        }
+
+        [[nodiscard]] double p999() const {
+            return value_at_percentile(99.9);
+        }
+
+        [[nodiscard]] double min() const {
+            return m_total_count == 0 ? std::numeric_limits<double>::quiet_NaN() : to_milliseconds(m_min);
+        }
+
+        [[nodiscard]] double max() const {
+            return m_total_count == 0 ? std::numeric_limits<double>::quiet_NaN() : to_milliseconds(m_max);
+        }
+
+        [[nodiscard]] double average() const {
+            return m_total_count == 0 ? std::numeric_limits<double>::quiet_NaN() : to_milliseconds(m_total) / static_cast<double>(m_total_count);
+        }
+
+        [[nodiscard]] double total() const {
+            return to_milliseconds(m_total);
+        }
+
+        [[nodiscard]] std::string s_total() const {
+            return format_time(total());
+        }
+
+        [[nodiscard]] std::string s_average() const {
+            return format_time(average());
+        }
+
+        // Number of buckets, fixed by the range and precision
+        [[nodiscard]] size_t bucket_count() const {
+            return m_counts.size();
+        }
+
+    private:
+        static double to_milliseconds(int64_t value_in_ns)
+        {
+            return fractional_milliseconds(std::chrono::nanoseconds(value_in_ns)).count();
+        }
+
+        [[nodiscard]] int bucket_index(int64_t value) const
+        {
+            const int pow2_ceiling = 64 - std::countl_zero(static_cast<uint64_t>(value | m_sub_bucket_mask));
+            return pow2_ceiling - m_unit_magnitude - (m_sub_bucket_half_count_magnitude + 1);
+        }
+
+        [[nodiscard]] int64_t sub_bucket_index(int64_t value, int bucket) const
+        {
+            return value >> (bucket + m_unit_magnitude);
+        }
+
+        [[nodiscard]] size_t counts_index_for(int64_t value) const
+        {
+            const int bucket = bucket_index(value);
+            const int64_t sub_bucket = sub_bucket_index(value, bucket);
+            const int64_t bucket_base = int64_t(bucket + 1) << m_sub_bucket_half_count_magnitude;
+            return static_cast<size_t>(bucket_base + (sub_bucket - m_sub_bucket_half_count));
+        }
+
+        [[nodiscard]] int64_t value_from_index(int bucket, int64_t sub_bucket) const
+        {
+            return sub_bucket << (bucket + m_unit_magnitude);
+        }
+
+        [[nodiscard]] int64_t value_at_index(size_t index) const
+        {
+            int bucket = static_cast<int>(index >> m_sub_bucket_half_count_magnitude) - 1;
+            int64_t sub_bucket = static_cast<int64_t>(index & static_cast<size_t>(m_sub_bucket_half_count - 1)) + m_sub_bucket_half_count;
+            if (bucket < 0)
+            {
+                sub_bucket -= m_sub_bucket_half_count;
+                bucket = 0;
+            }
+            return value_from_index(bucket, sub_bucket);
+        }
+
+        [[nodiscard]] int64_t highest_equivalent_value(int64_t value) const
+        {
+            const int bucket = bucket_index(value);
+            const int64_t sub_bucket = sub_bucket_index(value, bucket);
+            const int adjusted_bucket = sub_bucket >= m_sub_bucket_count ? bucket + 1 : bucket;
+            const int64_t range = int64_t(1) << (m_unit_magnitude + adjusted_bucket);
+            return value_from_index(bucket, sub_bucket) + range - 1;
+        }
+
+    private:
+        // Configuration, values are in nanoseconds
+        int64_t m_lowest_discernible;
+        int64_t m_highest_trackable;
+        int m_significant_digits;
+        // Bucket layout derived from the configuration
+        int m_unit_magnitude;
+        int m_sub_bucket_half_count_magnitude;
+        int64_t m_sub_bucket_count;
+        int64_t m_sub_bucket_half_count;
+        int64_t m_sub_bucket_mask;
+        // Recorded data
+        std::vector<uint64_t> m_counts;
+        uint64_t m_total_count = 0;
+        int64_t m_total = 0;
+        int64_t m_min = std::numeric_limits<int64_t>::max();
+        int64_t m_max = 0;
+    };
+}
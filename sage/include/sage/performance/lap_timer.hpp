@@ -0,0 +1,219 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "timer.hpp"
+#include "timer_monitor.hpp"
+
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sage::performance
+{
+    // Interface for monitors that take measurements for several phases, identified by the
+    // index they were registered at
+    class lap_monitor
+    {
+    public:
+        virtual ~lap_monitor() = default;
+        virtual void add_measurement(size_t phase, std::chrono::nanoseconds duration) = 0;
+    };
+
+    // Keeps streaming statistics for each phase. Phases are registered once, by name, and laps
+    // refer to them by index, so nothing is looked up by name while timing. Registering the
+    // names in the order of an enum lets laps use the enum values directly.
+    class multi_series_monitor final : public lap_monitor
+    {
+    public:
+        multi_series_monitor() = default;
+
+        multi_series_monitor(std::initializer_list<std::string> names)
+        {
+            for (const auto& name : names)
+            {
+                add_series(name);
+            }
+        }
+
+        // Returns the index of the new phase
+        size_t add_series(const std::string& name)
+        {
+            m_names.push_back(name);
+            m_series.emplace_back();
+            return m_series.size() - 1;
+        }
+
+        // Laps for a phase that was never registered are ignored
+        void add_measurement(size_t phase, std::chrono::nanoseconds duration) override
+        {
+            if (phase < m_series.size())
+            {
+                m_series[phase].add_measurement(duration);
+            }
+        }
+
+        [[nodiscard]] size_t series_count() const
+        {
+            return m_series.size();
+        }
+
+        [[nodiscard]] const std::string& name(size_t phase) const
+        {
+            return m_names[phase];
+        }
+
+        [[nodiscard]] const streaming_stats_monitor& series(size_t phase) const
+        {
+            return m_series[phase];
+        }
+
+        // Sum of every phase's total in milliseconds
+        [[nodiscard]] double total() const
+        {
+            double total = 0.0;
+            for (const auto& s : m_series)
+            {
+                total += s.total();
+            }
+            return total;
+        }
+
+        // One row per phase in registration order, with its share of the total time
+        void write_report(std::ostream& stream) const
+        {
+            const double overall = total();
+            stream << std::left << std::setw(32) << "phase" << std::right << std::setw(12) << "laps" << std::setw(14) << "total"
+                   << std::setw(14) << "average" << std::setw(10) << "share" << std::endl;
+            for (size_t i = 0; i < m_series.size(); ++i)
+            {
+                const auto& s = m_series[i];
+                std::ostringstream share;
+                share << std::fixed << std::setprecision(1) << (overall > 0.0 ? s.total() / overall * 100.0 : 0.0) << "%";
+                stream << std::left << std::setw(32) << m_names[i] << std::right << std::setw(12) << s.count() << std::setw(14) << s.s_total()
+                       << std::setw(14) << (s.count() > 0 ? s.s_average() : "-") << std::setw(10) << share.str() << std::endl;
+            }
+        }
+
+        [[nodiscard]] std::string report_string() const
+        {
+            std::stringstream ss;
+            write_report(ss);
+            return ss.str();
+        }
+
+    private:
+        std::vector<std::string> m_names;
+        std::vector<streaming_stats_monitor> m_series;
+    };
+
+    // Passes each phase's measurements to its own monitor
+    class phase_monitors final : public lap_monitor
+    {
+    public:
+        phase_monitors() = default;
+
+        phase_monitors(std::initializer_list<std::reference_wrapper<timer_monitor>> monitors) : m_monitors(monitors)
+        {
+        }
+
+        // Returns the index of the new phase
+        size_t add_phase(timer_monitor& monitor)
+        {
+            m_monitors.emplace_back(monitor);
+            return m_monitors.size() - 1;
+        }
+
+        // Laps for a phase without a monitor are ignored
+        void add_measurement(size_t phase, std::chrono::nanoseconds duration) override
+        {
+            if (phase < m_monitors.size())
+            {
+                m_monitors[phase].get().add_measurement(duration);
+            }
+        }
+
+    private:
+        std::vector<std::reference_wrapper<timer_monitor>> m_monitors;
+    };
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, the timer holds no state and laps do nothing
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_lap_timer
+    {
+    public:
+        explicit basic_lap_timer(lap_monitor&) noexcept
+        {
+        }
+
+        basic_lap_timer(const basic_lap_timer&) = delete;
+        basic_lap_timer& operator=(const basic_lap_timer&) = delete;
+
+        void lap(size_t) noexcept
+        {
+        }
+
+        template <typename EnumT>
+            requires std::is_enum_v<EnumT>
+        void lap(EnumT) noexcept
+        {
+        }
+
+        void restart() noexcept
+        {
+        }
+    };
+#else
+    // Times consecutive phases of one scope with a single clock reading per phase. Each lap()
+    // ends the current phase, attributing the time since the previous lap (or construction)
+    // to it, and starts the next. Time after the last lap is not reported.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_lap_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit basic_lap_timer(lap_monitor& monitor) : m_monitor(monitor)
+        {
+            m_last_time_point = detail::start_now<clock_t>();
+        }
+
+        basic_lap_timer(const basic_lap_timer&) = delete;
+        basic_lap_timer& operator=(const basic_lap_timer&) = delete;
+
+        void lap(size_t phase)
+        {
+            const auto now = detail::stop_now<clock_t>();
+            m_monitor.add_measurement(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_last_time_point));
+            m_last_time_point = now;
+        }
+
+        // Phases given as enum values, registered in the same order as the enumerators
+        template <typename EnumT>
+            requires std::is_enum_v<EnumT>
+        void lap(EnumT phase)
+        {
+            lap(static_cast<size_t>(phase));
+        }
+
+        // Starts the next phase now, without reporting the time since the last lap
+        void restart()
+        {
+            m_last_time_point = detail::start_now<clock_t>();
+        }
+
+    private:
+        lap_monitor& m_monitor;
+        time_point_t m_last_time_point;
+    };
+#endif
+
+    using lap_timer = basic_lap_timer<>;
+}
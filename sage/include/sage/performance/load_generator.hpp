@@ -0,0 +1,125 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "timer.hpp"
+#include "timer_monitor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace sage::performance
+{
+    struct load_options
+    {
+        // Requests issued per second
+        double rate = 1000.0;
+        // How long to issue requests for, rate * duration requests are issued in total
+        std::chrono::nanoseconds duration = std::chrono::seconds(10);
+    };
+
+    struct load_result
+    {
+        size_t requests = 0;
+        double target_rate = 0.0;
+        // Requests per second over the longer of the requested duration and the time until the
+        // last request finished, below the target when the callable could not keep up
+        double achieved_rate = 0.0;
+        std::chrono::nanoseconds elapsed{0};
+        // Longest a request started after its intended start time
+        std::chrono::nanoseconds max_start_delay{0};
+
+        // e.g. 10000 requests in 10.00s, achieved 1000.00/s of 1000.00/s target, max start delay 12.34us
+        [[nodiscard]] std::string s_summary() const
+        {
+            std::ostringstream ss;
+            ss << requests << " requests in " << format_duration(elapsed) << ", achieved " << std::fixed << std::setprecision(2) << achieved_rate
+               << "/s of " << target_rate << "/s target, max start delay " << format_duration(max_start_delay);
+            return ss.str();
+        }
+    };
+
+    namespace detail
+    {
+        // Sleeps until shortly before the deadline, as waking from a sleep is too coarse for
+        // sub-millisecond intervals, then spins the rest of the way
+        template <typename ClockT>
+        void wait_until(typename ClockT::time_point deadline)
+        {
+            constexpr auto spin_window = std::chrono::microseconds(200);
+            for (auto now = ClockT::now(); now < deadline; now = ClockT::now())
+            {
+                const auto remaining = deadline - now;
+                if (remaining > spin_window)
+                {
+                    std::this_thread::sleep_for(remaining - spin_window);
+                }
+            }
+        }
+    }
+
+    // Open loop load driver, calls func at a fixed rate from the calling thread whether or not
+    // earlier calls have finished on time. Each request's latency is measured from the time it
+    // was meant to start rather than when it actually did, so a stall also counts against every
+    // request that should have been issued during it. A closed loop that times calls back to
+    // back only sees the one slow call, which is coordinated omission, and under-reports the
+    // tail. Requests that fall behind are issued as soon as possible and none are dropped.
+    // Record into a histogram_monitor to read off the latency percentiles. The service time of
+    // each call, from its actual start, can be recorded alongside for comparison. func is
+    // passed the request index if it takes a size_t.
+    template <typename ClockT = std::chrono::steady_clock, typename FuncT>
+    load_result run_load(FuncT&& func, timer_monitor& latency_monitor, const load_options& options, timer_monitor* service_monitor = nullptr)
+    {
+        if (!(options.rate > 0.0))
+        {
+            throw std::invalid_argument("Error: Load rate must be greater than zero.");
+        }
+        if (options.duration <= std::chrono::nanoseconds(0))
+        {
+            throw std::invalid_argument("Error: Load duration must be greater than zero.");
+        }
+
+        const double interval_ns = 1e9 / options.rate;
+        const auto requests = static_cast<size_t>(std::llround(std::chrono::duration<double>(options.duration).count() * options.rate));
+
+        load_result result;
+        result.requests = requests;
+        result.target_rate = options.rate;
+        const auto start = ClockT::now();
+        auto last_end = start;
+        for (size_t i = 0; i < requests; ++i)
+        {
+            // Offsets from the start rather than accumulated intervals, so rounding does not drift
+            const auto intended = start + std::chrono::duration_cast<typename ClockT::duration>(std::chrono::duration<double, std::nano>(interval_ns * static_cast<double>(i)));
+            detail::wait_until<ClockT>(intended);
+            const auto actual = detail::start_now<ClockT>();
+            if constexpr (std::is_invocable_v<FuncT&, size_t>)
+            {
+                func(i);
+            }
+            else
+            {
+                func();
+            }
+            last_end = detail::stop_now<ClockT>();
+
+            latency_monitor.add_measurement(std::chrono::duration_cast<std::chrono::nanoseconds>(last_end - intended));
+            if (service_monitor != nullptr)
+            {
+                service_monitor->add_measurement(std::chrono::duration_cast<std::chrono::nanoseconds>(last_end - actual));
+            }
+            result.max_start_delay = std::max(result.max_start_delay, std::chrono::duration_cast<std::chrono::nanoseconds>(actual - intended));
+        }
+
+        result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(last_end - start);
+        const double seconds = std::chrono::duration<double>(std::max(result.elapsed, options.duration)).count();
+        result.achieved_rate = static_cast<double>(requests) / seconds;
+        return result;
+    }
+}
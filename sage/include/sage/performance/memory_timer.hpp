@@ -0,0 +1,399 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "throughput_timer.hpp"
+#include "timer.hpp"
+#include "platform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace sage::performance
+{
+    // Formats a byte count in decimal units, e.g. 12.34 MB
+    inline std::string format_bytes(double bytes)
+    {
+        const auto [value, prefix] = detail::si_scale(bytes);
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << value << " " << prefix << "B";
+        return ss.str();
+    }
+
+    // Process memory at one point in time. Page faults are counted since the process started.
+    struct memory_sample
+    {
+        // Resident set size, the memory the process currently has in RAM
+        int64_t rss = 0;
+        // Highest resident set size so far, the high water mark
+        int64_t peak_rss = 0;
+        // Faults served without I/O, e.g. the first touch of newly allocated memory
+        int64_t minor_faults = 0;
+        // Faults that had to read from disk
+        int64_t major_faults = 0;
+        // False where the resident set size can not be read
+        bool available = false;
+    };
+
+    // Change in process memory over a scope
+    struct memory_measurement
+    {
+        std::chrono::nanoseconds duration{0};
+        // Growth of the resident set, negative when memory was returned to the OS
+        int64_t rss_delta = 0;
+        // Resident set high water mark at the end of the scope, and how much it rose in it
+        int64_t peak_rss = 0;
+        int64_t peak_rss_delta = 0;
+        int64_t minor_faults = 0;
+        int64_t major_faults = 0;
+    };
+
+    // Interface for monitors that take memory measurements. A measurement is several values in
+    // different units, which a timer_monitor, taking a single duration, can not carry, so memory
+    // has its own interface. memory_value_monitor passes one of the values on to a timer_monitor.
+    class memory_monitor
+    {
+    public:
+        virtual ~memory_monitor() = default;
+        virtual void add_measurement(const memory_measurement& measurement) = 0;
+    };
+
+    // Which value of a memory_measurement a memory_value_monitor passes on
+    enum class memory_value
+    {
+        duration,
+        rss_delta,
+        peak_rss,
+        peak_rss_delta,
+        minor_faults,
+        major_faults
+    };
+
+    // Adaptor that passes one value of each memory measurement to a timer_monitor, so the
+    // existing sinks (async_monitor, the monitor registry, binary logs, histograms) can record
+    // memory as well. Values other than the duration travel unchanged as the nanosecond count,
+    // 4096 bytes arrive as 4096ns, so read them from raw counts or scale reported milliseconds
+    // back up by a million.
+    // Sinks that only keep non-negative values, such as histogram_monitor, clamp a shrinking
+    // resident set to zero.
+    class memory_value_monitor final : public memory_monitor
+    {
+    public:
+        memory_value_monitor(timer_monitor& monitor, memory_value value) : m_monitor(monitor), m_value(value)
+        {
+        }
+
+        void add_measurement(const memory_measurement& measurement) override
+        {
+            m_monitor.add_measurement(m_value == memory_value::duration ? measurement.duration : std::chrono::nanoseconds(value_of(measurement)));
+        }
+
+    private:
+        [[nodiscard]] int64_t value_of(const memory_measurement& measurement) const
+        {
+            switch (m_value)
+            {
+            case memory_value::rss_delta:
+                return measurement.rss_delta;
+            case memory_value::peak_rss:
+                return measurement.peak_rss;
+            case memory_value::peak_rss_delta:
+                return measurement.peak_rss_delta;
+            case memory_value::minor_faults:
+                return measurement.minor_faults;
+            case memory_value::major_faults:
+                return measurement.major_faults;
+            case memory_value::duration:
+                break;
+            }
+            return measurement.duration.count();
+        }
+
+        timer_monitor& m_monitor;
+        memory_value m_value;
+    };
+
+    // Totals the faults and resident set growth it is given, and keeps the largest growth and
+    // the highest peak
+    class memory_summary_monitor final : public memory_monitor
+    {
+    public:
+        void add_measurement(const memory_measurement& measurement) override
+        {
+            ++m_count;
+            m_total_rss_delta += measurement.rss_delta;
+            m_largest_rss_delta = m_count == 1 ? measurement.rss_delta : (std::max)(m_largest_rss_delta, measurement.rss_delta);
+            m_peak_rss = (std::max)(m_peak_rss, measurement.peak_rss);
+            m_minor_faults += measurement.minor_faults;
+            m_major_faults += measurement.major_faults;
+        }
+
+        [[nodiscard]] size_t count() const
+        {
+            return m_count;
+        }
+
+        // In bytes
+        [[nodiscard]] int64_t total_rss_delta() const
+        {
+            return m_total_rss_delta;
+        }
+
+        [[nodiscard]] int64_t largest_rss_delta() const
+        {
+            return m_largest_rss_delta;
+        }
+
+        [[nodiscard]] int64_t peak_rss() const
+        {
+            return m_peak_rss;
+        }
+
+        [[nodiscard]] int64_t minor_faults() const
+        {
+            return m_minor_faults;
+        }
+
+        [[nodiscard]] int64_t major_faults() const
+        {
+            return m_major_faults;
+        }
+
+        [[nodiscard]] double average_minor_faults() const
+        {
+            return m_count == 0 ? 0.0 : static_cast<double>(m_minor_faults) / static_cast<double>(m_count);
+        }
+
+        // e.g. rss +12.00 MB (largest +4.00 MB), peak 250.00 MB, 3072 minor faults, 0 major faults
+        [[nodiscard]] std::string s_summary() const
+        {
+            const auto signed_bytes = [](int64_t bytes) {
+                std::string text = bytes >= 0 ? "+" : "-";
+                text += format_bytes(static_cast<double>(bytes >= 0 ? bytes : -bytes));
+                return text;
+            };
+            return "rss " + signed_bytes(m_total_rss_delta) + " (largest " + signed_bytes(m_largest_rss_delta) + "), peak " + format_bytes(static_cast<double>(m_peak_rss))
+                + ", " + std::to_string(m_minor_faults) + " minor faults, " + std::to_string(m_major_faults) + " major faults";
+        }
+
+    private:
+        size_t m_count = 0;
+        int64_t m_total_rss_delta = 0;
+        int64_t m_largest_rss_delta = 0;
+        int64_t m_peak_rss = 0;
+        int64_t m_minor_faults = 0;
+        int64_t m_major_faults = 0;
+    };
+
+    // Reads the current process memory. On Linux the resident set comes from /proc/self/statm,
+    // which each thread keeps open and re-reads with pread, and the high water mark and fault
+    // counts come from getrusage, so a sample makes no allocation. On Windows it comes from
+    // GetProcessMemoryInfo, which only counts faults in total, reported as minor faults.
+    inline memory_sample read_memory_sample() noexcept
+    {
+        const auto memory = detail::read_process_memory();
+        return {memory.rss, memory.peak_rss, memory.minor_faults, memory.major_faults, memory.rss_available};
+    }
+
+    // Change from one sample to a later one
+    inline memory_measurement memory_difference(const memory_sample& start, const memory_sample& end, std::chrono::nanoseconds duration)
+    {
+        return {duration,
+                end.rss - start.rss,
+                end.peak_rss,
+                end.peak_rss - start.peak_rss,
+                end.minor_faults - start.minor_faults,
+                end.major_faults - start.major_faults};
+    }
+
+    // Fields of /proc/self/status, in bytes. Reading and parsing the file is much slower than
+    // read_memory_sample(), so it suits occasional reports rather than every scope.
+    struct memory_status
+    {
+        // VmRSS and VmHWM, the resident set and its high water mark
+        int64_t rss = 0;
+        int64_t peak_rss = 0;
+        // VmSize and VmPeak, the virtual memory size and its high water mark
+        int64_t virtual_size = 0;
+        int64_t peak_virtual_size = 0;
+        bool available = false;
+    };
+
+    inline memory_status read_memory_status()
+    {
+        memory_status status;
+#if defined(__linux__)
+        FILE* file = std::fopen("/proc/self/status", "r");
+        if (file == nullptr)
+        {
+            return status;
+        }
+        char line[256];
+        while (std::fgets(line, sizeof(line), file) != nullptr)
+        {
+            long long kilobytes = 0;
+            if (std::sscanf(line, "VmRSS: %lld kB", &kilobytes) == 1)
+            {
+                status.rss = kilobytes * 1024;
+                status.available = true;
+            }
+            else if (std::sscanf(line, "VmHWM: %lld kB", &kilobytes) == 1)
+            {
+                status.peak_rss = kilobytes * 1024;
+            }
+            else if (std::sscanf(line, "VmSize: %lld kB", &kilobytes) == 1)
+            {
+                status.virtual_size = kilobytes * 1024;
+            }
+            else if (std::sscanf(line, "VmPeak: %lld kB", &kilobytes) == 1)
+            {
+                status.peak_virtual_size = kilobytes * 1024;
+            }
+        }
+        std::fclose(file);
+#endif
+        return status;
+    }
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, the timer holds no state and does nothing
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_memory_timer
+    {
+    public:
+        explicit basic_memory_timer(memory_monitor&) noexcept
+        {
+        }
+
+        basic_memory_timer(const basic_memory_timer&) = delete;
+        basic_memory_timer& operator=(const basic_memory_timer&) = delete;
+    };
+#else
+    // RAII timer that reports how the process memory changed over its scope along with the
+    // scope's duration. The resident set is process wide, so concurrent scopes on other
+    // threads show up in each other's deltas.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_memory_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit basic_memory_timer(memory_monitor& monitor) : m_monitor(monitor)
+        {
+            m_start_sample = read_memory_sample();
+            m_start_time_point = detail::start_now<clock_t>();
+        }
+
+        ~basic_memory_timer()
+        {
+            const auto end_time_point = detail::stop_now<clock_t>();
+            const auto end_sample = read_memory_sample();
+            m_monitor.add_measurement(memory_difference(m_start_sample, end_sample, std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_point - m_start_time_point)));
+        }
+
+        basic_memory_timer(const basic_memory_timer&) = delete;
+        basic_memory_timer& operator=(const basic_memory_timer&) = delete;
+
+    private:
+        memory_monitor& m_monitor;
+        memory_sample m_start_sample;
+        time_point_t m_start_time_point;
+    };
+#endif
+
+    using memory_timer = basic_memory_timer<>;
+
+    // Samples process memory on a background thread at a fixed interval and reports the
+    // change since the previous sample to the monitor, for watching memory over a whole run
+    // without instrumenting any scope. The monitor is only called from the sampling thread.
+    class memory_sampler
+    {
+    public:
+        explicit memory_sampler(memory_monitor& monitor, std::chrono::milliseconds interval = std::chrono::milliseconds(100))
+            : m_monitor(monitor)
+            , m_interval(interval)
+        {
+            m_worker = std::thread([this]() { run(); });
+        }
+
+        ~memory_sampler()
+        {
+            stop();
+        }
+
+        memory_sampler(const memory_sampler&) = delete;
+        memory_sampler& operator=(const memory_sampler&) = delete;
+
+        // Takes a last sample and stops the sampling thread
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_wake.notify_one();
+            if (m_worker.joinable())
+            {
+                m_worker.join();
+            }
+        }
+
+        // The most recent sample, and the number taken so far
+        [[nodiscard]] memory_sample latest() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_latest;
+        }
+
+        [[nodiscard]] size_t samples() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_samples;
+        }
+
+    private:
+        void run()
+        {
+            auto previous = read_memory_sample();
+            auto previous_time_point = std::chrono::steady_clock::now();
+            bool stopping = false;
+            while (!stopping)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wake.wait_for(lock, m_interval, [this]() { return m_stopping; });
+                    stopping = m_stopping;
+                }
+                const auto sample = read_memory_sample();
+                const auto time_point = std::chrono::steady_clock::now();
+                m_monitor.add_measurement(memory_difference(previous, sample, std::chrono::duration_cast<std::chrono::nanoseconds>(time_point - previous_time_point)));
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_latest = sample;
+                    ++m_samples;
+                }
+                previous = sample;
+                previous_time_point = time_point;
+            }
+        }
+
+    private:
+        memory_monitor& m_monitor;
+        std::chrono::milliseconds m_interval;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stopping = false;
+        memory_sample m_latest;
+        size_t m_samples = 0;
+        std::thread m_worker;
+    };
+}
@@ -0,0 +1,365 @@
+#pragma once
+
+#include "histogram_monitor.hpp"
+#include "thread_shards.hpp"
+#include "timer_monitor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sage::performance
+{
+    // Thread safe monitor owned by a monitor_registry. Each recording thread adds to its own
+    // histogram, guarded by a lock that is only contended while a snapshot is being taken.
+    class registered_monitor final : public timer_monitor
+    {
+    public:
+        registered_monitor(std::string name,
+                           std::string help,
+                           std::chrono::nanoseconds lowest_discernible,
+                           std::chrono::nanoseconds highest_trackable,
+                           int significant_digits)
+            : m_name(std::move(name))
+            , m_help(std::move(help))
+            , m_lowest_discernible(lowest_discernible)
+            , m_highest_trackable(highest_trackable)
+            , m_significant_digits(significant_digits)
+        {
+        }
+
+        registered_monitor(const registered_monitor&) = delete;
+        registered_monitor& operator=(const registered_monitor&) = delete;
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            auto& s = m_shards.local();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (!s.histogram)
+            {
+                s.histogram.emplace(m_lowest_discernible, m_highest_trackable, m_significant_digits);
+            }
+            s.histogram->add_measurement(duration);
+        }
+
+        [[nodiscard]] const std::string& name() const
+        {
+            return m_name;
+        }
+
+        [[nodiscard]] const std::string& help() const
+        {
+            return m_help;
+        }
+
+        // Every thread's measurements merged into one histogram
+        [[nodiscard]] histogram_monitor snapshot() const
+        {
+            histogram_monitor merged = empty_histogram();
+            m_shards.for_each([&merged](const shard& s) {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (s.histogram)
+                {
+                    merged.merge(*s.histogram);
+                }
+            });
+            return merged;
+        }
+
+    private:
+        friend class monitor_registry;
+
+        struct shard
+        {
+            mutable std::mutex mutex;
+            // Created by the owning thread on its first measurement
+            std::optional<histogram_monitor> histogram;
+        };
+
+        [[nodiscard]] histogram_monitor empty_histogram() const
+        {
+            return histogram_monitor(m_lowest_discernible, m_highest_trackable, m_significant_digits);
+        }
+
+    private:
+        std::string m_name;
+        std::string m_help;
+        std::chrono::nanoseconds m_lowest_discernible;
+        std::chrono::nanoseconds m_highest_trackable;
+        int m_significant_digits;
+        detail::thread_shards<shard> m_shards;
+    };
+
+    struct monitor_snapshot
+    {
+        std::string name;
+        std::string help;
+        histogram_monitor histogram;
+    };
+
+    struct registry_snapshot
+    {
+        std::chrono::system_clock::time_point taken;
+        // In registration order
+        std::vector<monitor_snapshot> monitors;
+    };
+
+    // Writes each monitor as a Prometheus summary named <name>_seconds, with the 0.5, 0.9, 0.99
+    // and 0.999 quantiles, sum and count, in the Prometheus text exposition format
+    inline void write_prometheus(std::ostream& stream, const registry_snapshot& snapshot)
+    {
+        const auto write_value = [&stream](double value) {
+            if (std::isnan(value))
+            {
+                stream << "NaN";
+            }
+            else
+            {
+                stream << value;
+            }
+        };
+
+        const auto precision = stream.precision(9);
+        for (const auto& monitor : snapshot.monitors)
+        {
+            const std::string metric = monitor.name + "_seconds";
+            if (!monitor.help.empty())
+            {
+                stream << "# HELP " << metric << " ";
+                for (const char c : monitor.help)
+                {
+                    if (c == '\\')
+                    {
+                        stream << "\\\\";
+                    }
+                    else if (c == '\n')
+                    {
+                        stream << "\\n";
+                    }
+                    else
+                    {
+                        stream << c;
+                    }
+                }
+                stream << "\n";
+            }
+            stream << "# TYPE " << metric << " summary\n";
+            for (const double quantile : {0.5, 0.9, 0.99, 0.999})
+            {
+                stream << metric << "{quantile=\"" << quantile << "\"} ";
+                write_value(monitor.histogram.value_at_percentile(quantile * 100.0) / 1000.0);
+                stream << "\n";
+            }
+            stream << metric << "_sum ";
+            write_value(monitor.histogram.total() / 1000.0);
+            stream << "\n" << metric << "_count " << monitor.histogram.count() << "\n";
+        }
+        stream.precision(precision);
+    }
+
+    // Process wide set of monitors looked up by name. A monitor is created the first time its
+    // name is asked for and lives as long as the registry, so references to it stay valid.
+    // Lookups of an existing name read a fixed size open addressing table of atomic pointers
+    // and never lock, only creating a monitor takes the registry lock. Names follow the
+    // Prometheus metric name rules, [a-zA-Z_:][a-zA-Z0-9_:]*.
+    class monitor_registry
+    {
+    public:
+        explicit monitor_registry(size_t capacity = 1024,
+                                  std::chrono::nanoseconds lowest_discernible = std::chrono::microseconds(1),
+                                  std::chrono::nanoseconds highest_trackable = std::chrono::minutes(1),
+                                  int significant_digits = 2)
+            : m_capacity(capacity)
+            , m_lowest_discernible(lowest_discernible)
+            , m_highest_trackable(highest_trackable)
+            , m_significant_digits(significant_digits)
+        {
+            // At most half full, so probing always reaches an empty slot
+            size_t table_size = 2;
+            while (table_size < 2 * m_capacity)
+            {
+                table_size <<= 1;
+            }
+            m_table = std::make_unique<std::atomic<registered_monitor*>[]>(table_size);
+            m_mask = table_size - 1;
+            // Checks the histogram configuration up front rather than on first measurement
+            static_cast<void>(histogram_monitor(lowest_discernible, highest_trackable, significant_digits));
+        }
+
+        monitor_registry(const monitor_registry&) = delete;
+        monitor_registry& operator=(const monitor_registry&) = delete;
+
+        static monitor_registry& instance()
+        {
+            static monitor_registry registry;
+            return registry;
+        }
+
+        // Returns the monitor with this name, creating it if needed. The help text is only used
+        // when the monitor is created.
+        registered_monitor& get(std::string_view name, std::string_view help = {})
+        {
+            if (auto* monitor = find(name))
+            {
+                return *monitor;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (auto* monitor = find(name))
+            {
+                return *monitor;
+            }
+            if (!is_valid_name(name))
+            {
+                throw std::invalid_argument("Error: Invalid monitor name " + std::string(name) + ", names must match [a-zA-Z_:][a-zA-Z0-9_:]*.");
+            }
+            if (m_monitors.size() >= m_capacity)
+            {
+                throw std::runtime_error("Error: Monitor registry is full, unable to register " + std::string(name) + ".");
+            }
+            auto& monitor = m_monitors.emplace_back(std::make_unique<registered_monitor>(std::string(name), std::string(help), m_lowest_discernible, m_highest_trackable, m_significant_digits));
+            size_t index = slot_for(name);
+            while (m_table[index].load(std::memory_order_relaxed) != nullptr)
+            {
+                index = (index + 1) & m_mask;
+            }
+            m_table[index].store(monitor.get(), std::memory_order_release);
+            return *monitor;
+        }
+
+        // Returns nullptr if there is no monitor with this name, never locks
+        [[nodiscard]] registered_monitor* find(std::string_view name) const
+        {
+            for (size_t index = slot_for(name);; index = (index + 1) & m_mask)
+            {
+                auto* monitor = m_table[index].load(std::memory_order_acquire);
+                if (monitor == nullptr || monitor->name() == name)
+                {
+                    return monitor;
+                }
+            }
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_monitors.size();
+        }
+
+        // Every monitor's measurements at a single point in time. Recording threads are held up
+        // while their histograms are copied.
+        [[nodiscard]] registry_snapshot snapshot() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<std::vector<const registered_monitor::shard*>> shards(m_monitors.size());
+            for (size_t i = 0; i < m_monitors.size(); ++i)
+            {
+                m_monitors[i]->m_shards.for_each([&shards, i](const registered_monitor::shard& s) { shards[i].push_back(&s); });
+            }
+            // Recording threads only ever hold their own shard's lock, so taking them all in any
+            // order can not deadlock
+            std::vector<std::unique_lock<std::mutex>> shard_locks;
+            for (const auto& monitor_shards : shards)
+            {
+                for (const auto* s : monitor_shards)
+                {
+                    shard_locks.emplace_back(s->mutex);
+                }
+            }
+
+            registry_snapshot result{std::chrono::system_clock::now(), {}};
+            result.monitors.reserve(m_monitors.size());
+            for (size_t i = 0; i < m_monitors.size(); ++i)
+            {
+                auto histogram = m_monitors[i]->empty_histogram();
+                for (const auto* s : shards[i])
+                {
+                    if (s->histogram)
+                    {
+                        histogram.merge(*s->histogram);
+                    }
+                }
+                result.monitors.push_back({m_monitors[i]->name(), m_monitors[i]->help(), std::move(histogram)});
+            }
+            return result;
+        }
+
+        void write_prometheus(std::ostream& stream) const
+        {
+            sage::performance::write_prometheus(stream, snapshot());
+        }
+
+        [[nodiscard]] std::string prometheus_string() const
+        {
+            std::ostringstream stream;
+            write_prometheus(stream);
+            return stream.str();
+        }
+
+        // Writes to a temporary file next to file_path and renames it into place, so a scraper
+        // reading the file never sees it half written
+        void write_prometheus(const std::filesystem::path& file_path) const
+        {
+            auto temporary_path = file_path;
+            temporary_path += ".tmp";
+            {
+                std::ofstream file(temporary_path);
+                if (!file)
+                {
+                    throw std::runtime_error("Error: Unable to open metrics file " + temporary_path.string() + " for writing.");
+                }
+                write_prometheus(file);
+                if (!file.flush())
+                {
+                    throw std::runtime_error("Error: Unable to write metrics file " + temporary_path.string() + ".");
+                }
+            }
+            std::filesystem::rename(temporary_path, file_path);
+        }
+
+    private:
+        static bool is_valid_name(std::string_view name)
+        {
+            const auto is_alpha = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':'; };
+            if (name.empty() || !is_alpha(name.front()))
+            {
+                return false;
+            }
+            for (const char c : name)
+            {
+                if (!is_alpha(c) && !(c >= '0' && c <= '9'))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] size_t slot_for(std::string_view name) const
+        {
+            return std::hash<std::string_view>{}(name) & m_mask;
+        }
+
+    private:
+        size_t m_capacity;
+        std::chrono::nanoseconds m_lowest_discernible;
+        std::chrono::nanoseconds m_highest_trackable;
+        int m_significant_digits;
+        std::unique_ptr<std::atomic<registered_monitor*>[]> m_table;
+        size_t m_mask;
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<registered_monitor>> m_monitors;
+    };
+}
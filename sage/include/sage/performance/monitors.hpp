@@ -1,36 +1,78 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <iostream>
+#include <iomanip>
 #include <thread>
 #include <vector>
 #include <random>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <numeric>
 #include <sstream>
 
 #include "timer.hpp"
+#include "thread_shards.hpp"
 
 // Some basic semi useful client derived monitors
 namespace sage::performance
 {
+    // Measurements are reported as fractional milliseconds so sub-millisecond timings are not lost
+    using fractional_milliseconds = std::chrono::duration<double, std::milli>;
+
+    inline std::string format_time(double duration_in_ms) {
+        auto ms = std::chrono::duration<double>(duration_in_ms * 0.001);
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(ms);
+        ms -= std::chrono::duration_cast<std::chrono::milliseconds>(secs);
+        auto mins = std::chrono::duration_cast<std::chrono::minutes>(secs);
+        secs -= std::chrono::duration_cast<std::chrono::seconds>(mins);
+        const auto hour = std::chrono::duration_cast<std::chrono::hours>(mins);
+        mins -= std::chrono::duration_cast<std::chrono::minutes>(hour);
+
+        std::stringstream ss;
+        ss << std::setw(2) << std::setfill('0') << hour.count() << ":" <<std::setw(2) << std::setfill('0') <<  mins.count() << ":" << std::setw(2) << std::setfill('0') << secs.count() << ":" << std::setw(3) << std::setfill('0') << std::chrono::duration_cast<std::chrono::milliseconds>(ms).count();
+        return ss.str();
+    }
+
+    // Formats a duration with the largest unit that keeps it above 1, e.g. 12.34us
+    inline std::string format_duration(std::chrono::duration<double, std::nano> duration) {
+        const double ns = duration.count();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        if (std::abs(ns) < 1e3) {
+            ss << ns << "ns";
+        } else if (std::abs(ns) < 1e6) {
+            ss << ns / 1e3 << "us";
+        } else if (std::abs(ns) < 1e9) {
+            ss << ns / 1e6 << "ms";
+        } else {
+            ss << ns / 1e9 << "s";
+        }
+        return ss.str();
+    }
+
     class cout_monitor final : public timer_monitor
     {
     public:
-        void add_measurement(std::chrono::milliseconds duration_in_ms) override
+        void add_measurement(std::chrono::nanoseconds duration) override
         {
-            std::cout << "Duration: " << duration_in_ms.count() << std::endl;
+            std::cout << "Duration: " << fractional_milliseconds(duration).count() << "ms" << std::endl;
         }
     };
 
     class performance_monitor final : public timer_monitor
     {
     public:
-        void add_measurement(std::chrono::milliseconds duration_in_ms) override
+        void add_measurement(std::chrono::nanoseconds duration) override
         {
-            m_measurements.push_back(duration_in_ms.count());
+            m_measurements.push_back(fractional_milliseconds(duration).count());
         }
 
+        // Measurements in milliseconds
         [[nodiscard]] std::vector<double> get_measurements() const
         {
             return m_measurements;
@@ -53,21 +95,226 @@ namespace sage::performance
         }
 
     private:
-        static std::string format_time(double duration_in_ms) {
-            auto ms = std::chrono::duration<double>(duration_in_ms * 0.001);
-            auto secs = std::chrono::duration_cast<std::chrono::seconds>(ms);
-            ms -= std::chrono::duration_cast<std::chrono::milliseconds>(secs);
-            auto mins = std::chrono::duration_cast<std::chrono::minutes>(secs);
-            secs -= std::chrono::duration_cast<std::chrono::seconds>(mins);
-            const auto hour = std::chrono::duration_cast<std::chrono::hours>(mins);
-            mins -= std::chrono::duration_cast<std::chrono::minutes>(hour);
+        std::vector<double> m_measurements;
+    };
+
+    // Keeps running statistics instead of every measurement, so memory use and the cost of
+    // every query stay constant no matter how many measurements are added. Uses Welford's
+    // online algorithm for the mean and variance, and Chan et al's parallel update to merge
+    // two monitors, e.g. per thread monitors combined for reporting.
+    class streaming_stats_monitor final : public timer_monitor
+    {
+    public:
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            const double value = fractional_milliseconds(duration).count();
+            ++m_count;
+            const double delta = value - m_mean;
+            m_mean += delta / static_cast<double>(m_count);
+            m_sum_squared_deviations += delta * (value - m_mean);
+            m_min = std::min(m_min, value);
+            m_max = std::max(m_max, value);
+        }
+
+        void merge(const streaming_stats_monitor& other)
+        {
+            if (other.m_count == 0)
+            {
+                return;
+            }
+            if (m_count == 0)
+            {
+                *this = other;
+                return;
+            }
+            const auto count = static_cast<double>(m_count);
+            const auto other_count = static_cast<double>(other.m_count);
+            const double combined_count = count + other_count;
+            const double delta = other.m_mean - m_mean;
+            m_mean += delta * other_count / combined_count;
+            m_sum_squared_deviations += other.m_sum_squared_deviations + delta * delta * count * other_count / combined_count;
+            m_count += other.m_count;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        void reset()
+        {
+            *this = streaming_stats_monitor();
+        }
+
+        [[nodiscard]] size_t count() const {
+            return m_count;
+        }
 
-            std::stringstream ss;
-            ss << std::setw(2) << std::setfill('0') << hour.count() << ":" <<std::setw(2) << std::setfill('0') <<  mins.count() << ":" << std::setw(2) << std::setfill('0') << secs.count() << ":" << std::setw(3) << std::setfill('0') << std::chrono::duration_cast<std::chrono::milliseconds>(ms).count();
-            return ss.str();
+        // Statistics in milliseconds, NaN until a measurement has been added
+        [[nodiscard]] double average() const {
+            return m_count == 0 ? std::numeric_limits<double>::quiet_NaN() : m_mean;
+        }
+
+        [[nodiscard]] double total() const {
+            return m_mean * static_cast<double>(m_count);
+        }
+
+        // Sample variance in milliseconds squared
+        [[nodiscard]] double variance() const {
+            return m_count < 2 ? 0.0 : m_sum_squared_deviations / static_cast<double>(m_count - 1);
+        }
+
+        [[nodiscard]] double stddev() const {
+            return std::sqrt(variance());
+        }
+
+        [[nodiscard]] double min() const {
+            return m_count == 0 ? std::numeric_limits<double>::quiet_NaN() : m_min;
+        }
+
+        [[nodiscard]] double max() const {
+            return m_count == 0 ? std::numeric_limits<double>::quiet_NaN() : m_max;
+        }
+
+        [[nodiscard]] std::string s_total() const {
+            return format_time(total());
+        }
+
+        [[nodiscard]] std::string s_average() const {
+            return format_time(average());
         }
 
     private:
-        std::vector<double> m_measurements;
+        size_t m_count = 0;
+        double m_mean = 0.0;
+        double m_sum_squared_deviations = 0.0;
+        double m_min = std::numeric_limits<double>::infinity();
+        double m_max = -std::numeric_limits<double>::infinity();
+    };
+
+    // Performance monitor that can be shared between threads. Each thread appends to its own
+    // shard so recording never takes a lock or contends with other recording threads, the
+    // shards are only merged when the measurements or the statistics are asked for.
+    class concurrent_performance_monitor final : public timer_monitor
+    {
+    public:
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            m_shards.local().push(fractional_milliseconds(duration).count());
+        }
+
+        // Measurements in milliseconds, grouped by recording thread
+        [[nodiscard]] std::vector<double> get_measurements() const
+        {
+            std::vector<double> measurements;
+            m_shards.for_each([&measurements](const shard& s) { s.append_to(measurements); });
+            return measurements;
+        }
+
+        [[nodiscard]] size_t count() const {
+            size_t count = 0;
+            m_shards.for_each([&count](const shard& s) { count += s.size(); });
+            return count;
+        }
+
+        [[nodiscard]] double average() const {
+            double total = 0.0;
+            size_t count = 0;
+            m_shards.for_each([&total, &count](const shard& s) {
+                total += s.total();
+                count += s.size();
+            });
+            return total / count;
+        }
+
+        [[nodiscard]] double total() const {
+            double total = 0.0;
+            m_shards.for_each([&total](const shard& s) { total += s.total(); });
+            return total;
+        }
+
+        [[nodiscard]] std::string s_total() const {
+            return format_time(total());
+        }
+
+        [[nodiscard]] std::string s_average() const {
+            return format_time(average());
+        }
+
+    private:
+        // Append only storage with a single writer, values live in fixed size chunks that are
+        // never moved so readers can walk the published prefix while the owner keeps writing
+        class alignas(64) shard
+        {
+        public:
+            shard() : m_tail(&m_head), m_tail_size(0)
+            {
+            }
+
+            ~shard()
+            {
+                auto* current = m_head.next.load(std::memory_order_relaxed);
+                while (current != nullptr)
+                {
+                    auto* next = current->next.load(std::memory_order_relaxed);
+                    delete current;
+                    current = next;
+                }
+            }
+
+            void push(double value)
+            {
+                if (m_tail_size == chunk_size)
+                {
+                    auto* new_chunk = new chunk();
+                    m_tail->next.store(new_chunk, std::memory_order_release);
+                    m_tail = new_chunk;
+                    m_tail_size = 0;
+                }
+                m_tail->values[m_tail_size++] = value;
+                m_total.store(m_total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+                m_size.store(m_size.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            void append_to(std::vector<double>& measurements) const
+            {
+                size_t remaining = m_size.load(std::memory_order_acquire);
+                measurements.reserve(measurements.size() + remaining);
+                const chunk* current = &m_head;
+                while (remaining > 0)
+                {
+                    const size_t n = std::min(remaining, chunk_size);
+                    measurements.insert(measurements.end(), current->values.begin(), current->values.begin() + n);
+                    remaining -= n;
+                    current = current->next.load(std::memory_order_acquire);
+                }
+            }
+
+            [[nodiscard]] size_t size() const
+            {
+                return m_size.load(std::memory_order_acquire);
+            }
+
+            [[nodiscard]] double total() const
+            {
+                return m_total.load(std::memory_order_relaxed);
+            }
+
+        private:
+            static constexpr size_t chunk_size = 1024;
+
+            struct chunk
+            {
+                std::array<double, chunk_size> values;
+                std::atomic<chunk*> next{nullptr};
+            };
+
+            chunk m_head;
+            // Only touched by the owning thread
+            chunk* m_tail;
+            size_t m_tail_size;
+            // Published to readers
+            std::atomic<size_t> m_size{0};
+            std::atomic<double> m_total{0.0};
+        };
+
+        detail::thread_shards<shard> m_shards;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <vector>
+
+// Operating system calls used by the performance headers, kept in one place so the platform
+// headers are only pulled in here. windows.h is included with NOMINMAX, as min and max macros
+// would break min() and max() members and std::numeric_limits<>::max() across the library.
+// NOMINMAX is only defined around the include and restored afterwards, so no macro of ours
+// is left behind in the user's code.
+#if defined(_WIN32)
+#pragma push_macro("NOMINMAX")
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma pop_macro("NOMINMAX")
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#endif
+
+namespace sage::performance
+{
+    namespace detail
+    {
+#if defined(_WIN32)
+        // FILETIME counts 100ns intervals
+        inline std::chrono::nanoseconds from_filetime(const FILETIME& time)
+        {
+            const uint64_t intervals = (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            return std::chrono::nanoseconds(static_cast<int64_t>(intervals) * 100);
+        }
+#else
+        inline std::chrono::nanoseconds from_timespec(const timespec& time)
+        {
+            return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+        }
+
+        inline std::chrono::nanoseconds from_timeval(const timeval& time)
+        {
+            return std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec);
+        }
+#endif
+
+        // User and system (kernel) CPU time used so far
+        struct cpu_usage_times
+        {
+            std::chrono::nanoseconds user{0};
+            std::chrono::nanoseconds system{0};
+        };
+
+        // CPU time of the calling thread, from CLOCK_THREAD_CPUTIME_ID or GetThreadTimes
+        inline std::chrono::nanoseconds thread_cpu_time() noexcept
+        {
+#if defined(_WIN32)
+            FILETIME creation, exit, kernel, user;
+            GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+            return from_filetime(kernel) + from_filetime(user);
+#else
+            timespec time{};
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+            return from_timespec(time);
+#endif
+        }
+
+        // CPU time of every thread in the process, from CLOCK_PROCESS_CPUTIME_ID or
+        // GetProcessTimes
+        inline std::chrono::nanoseconds process_cpu_time() noexcept
+        {
+#if defined(_WIN32)
+            FILETIME creation, exit, kernel, user;
+            GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+            return from_filetime(kernel) + from_filetime(user);
+#else
+            timespec time{};
+            clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+            return from_timespec(time);
+#endif
+        }
+
+        // User and system time of the calling thread, or of the process where the platform can
+        // not tell threads apart
+        inline cpu_usage_times thread_cpu_usage() noexcept
+        {
+            cpu_usage_times times;
+#if defined(_WIN32)
+            FILETIME creation, exit, kernel, user;
+            GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+            times.user = from_filetime(user);
+            times.system = from_filetime(kernel);
+#else
+#if defined(RUSAGE_THREAD)
+            const int who = RUSAGE_THREAD;
+#else
+            const int who = RUSAGE_SELF;
+#endif
+            rusage usage{};
+            getrusage(who, &usage);
+            times.user = from_timeval(usage.ru_utime);
+            times.system = from_timeval(usage.ru_stime);
+#endif
+            return times;
+        }
+
+        inline cpu_usage_times process_cpu_usage() noexcept
+        {
+            cpu_usage_times times;
+#if defined(_WIN32)
+            FILETIME creation, exit, kernel, user;
+            GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+            times.user = from_filetime(user);
+            times.system = from_filetime(kernel);
+#else
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+            times.user = from_timeval(usage.ru_utime);
+            times.system = from_timeval(usage.ru_stime);
+#endif
+            return times;
+        }
+
+        // Pins the calling thread to the index-th CPU it is allowed to run on, wrapping around
+        // when there are fewer CPUs than threads. Returns false where pinning is not supported or
+        // not permitted.
+        inline bool pin_current_thread(size_t index)
+        {
+#if defined(_WIN32)
+            DWORD_PTR process_mask = 0;
+            DWORD_PTR system_mask = 0;
+            if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) || process_mask == 0)
+            {
+                return false;
+            }
+            std::vector<DWORD_PTR> allowed;
+            for (size_t cpu = 0; cpu < sizeof(DWORD_PTR) * 8; ++cpu)
+            {
+                if (process_mask & (DWORD_PTR(1) << cpu))
+                {
+                    allowed.push_back(DWORD_PTR(1) << cpu);
+                }
+            }
+            return SetThreadAffinityMask(GetCurrentThread(), allowed[index % allowed.size()]) != 0;
+#elif defined(__linux__)
+            cpu_set_t process_set;
+            CPU_ZERO(&process_set);
+            if (sched_getaffinity(0, sizeof(process_set), &process_set) != 0)
+            {
+                return false;
+            }
+            std::vector<int> allowed;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &process_set))
+                {
+                    allowed.push_back(cpu);
+                }
+            }
+            if (allowed.empty())
+            {
+                return false;
+            }
+            cpu_set_t thread_set;
+            CPU_ZERO(&thread_set);
+            CPU_SET(allowed[index % allowed.size()], &thread_set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(thread_set), &thread_set) == 0;
+#else
+            static_cast<void>(index);
+            return false;
+#endif
+        }
+
+        // Memory of the whole process, faults are counted since it started
+        struct process_memory
+        {
+            int64_t rss = 0;
+            int64_t peak_rss = 0;
+            int64_t minor_faults = 0;
+            int64_t major_faults = 0;
+            bool rss_available = false;
+        };
+
+#if defined(__linux__)
+        // /proc/self/statm kept open and re-read with pread. The descriptor is remembered with the
+        // pid it was opened in, a forked child inherits it but would read its parent's statm
+        // through it, so the file is reopened whenever the pid changes. One per thread, closed
+        // when the thread exits, so samples from different threads do not race.
+        class statm_file
+        {
+        public:
+            statm_file() = default;
+            statm_file(const statm_file&) = delete;
+            statm_file& operator=(const statm_file&) = delete;
+
+            ~statm_file()
+            {
+                if (m_fd >= 0)
+                {
+                    ::close(m_fd);
+                }
+            }
+
+            // Resident set size in pages
+            bool read_resident(int64_t& pages) noexcept
+            {
+                const pid_t pid = ::getpid();
+                if (m_fd < 0 || pid != m_pid)
+                {
+                    if (m_fd >= 0)
+                    {
+                        ::close(m_fd);
+                    }
+                    m_fd = ::open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+                    m_pid = pid;
+                }
+                char buffer[128];
+                const auto length = m_fd < 0 ? -1 : ::pread(m_fd, buffer, sizeof(buffer) - 1, 0);
+                if (length <= 0)
+                {
+                    return false;
+                }
+                buffer[length] = '\0';
+                long long size = 0;
+                long long resident = 0;
+                if (std::sscanf(buffer, "%lld %lld", &size, &resident) != 2)
+                {
+                    return false;
+                }
+                pages = resident;
+                return true;
+            }
+
+        private:
+            int m_fd = -1;
+            pid_t m_pid = 0;
+        };
+#endif
+
+        inline process_memory read_process_memory() noexcept
+        {
+            process_memory memory;
+#if defined(_WIN32)
+            PROCESS_MEMORY_COUNTERS counters{};
+            if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            {
+                memory.rss = static_cast<int64_t>(counters.WorkingSetSize);
+                memory.peak_rss = static_cast<int64_t>(counters.PeakWorkingSetSize);
+                memory.minor_faults = static_cast<int64_t>(counters.PageFaultCount);
+                memory.rss_available = true;
+            }
+#else
+            rusage usage{};
+            if (getrusage(RUSAGE_SELF, &usage) == 0)
+            {
+#if defined(__APPLE__)
+                // Bytes on macOS, kilobytes elsewhere
+                memory.peak_rss = static_cast<int64_t>(usage.ru_maxrss);
+#else
+                memory.peak_rss = static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+                memory.minor_faults = static_cast<int64_t>(usage.ru_minflt);
+                memory.major_faults = static_cast<int64_t>(usage.ru_majflt);
+            }
+#if defined(__linux__)
+            static thread_local statm_file statm;
+            static const int64_t page_size = ::sysconf(_SC_PAGESIZE);
+            int64_t resident = 0;
+            if (statm.read_resident(resident))
+            {
+                memory.rss = resident * page_size;
+                memory.rss_available = true;
+            }
+#endif
+#endif
+            return memory;
+        }
+
+        struct mapped_file
+        {
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+        };
+
+        // Maps a whole file read only, hinting that it will be read front to back. The mapping
+        // is empty if the file can not be opened or mapped, or has nothing in it.
+        inline mapped_file map_file(const std::filesystem::path& file_path) noexcept
+        {
+            mapped_file mapped;
+#if defined(_WIN32)
+            HANDLE file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return mapped;
+            }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+            {
+                CloseHandle(file);
+                return mapped;
+            }
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (mapping == nullptr)
+            {
+                return mapped;
+            }
+            void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (data == nullptr)
+            {
+                return mapped;
+            }
+            mapped.data = static_cast<const uint8_t*>(data);
+            mapped.size = static_cast<size_t>(size.QuadPart);
+#else
+            const int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return mapped;
+            }
+            struct stat status;
+            if (::fstat(fd, &status) != 0 || status.st_size == 0)
+            {
+                ::close(fd);
+                return mapped;
+            }
+            void* data = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED)
+            {
+                return mapped;
+            }
+            ::madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+            mapped.data = static_cast<const uint8_t*>(data);
+            mapped.size = static_cast<size_t>(status.st_size);
+#endif
+            return mapped;
+        }
+
+        inline void unmap_file(const mapped_file& mapped) noexcept
+        {
+            if (mapped.data == nullptr)
+            {
+                return;
+            }
+#if defined(_WIN32)
+            UnmapViewOfFile(mapped.data);
+#else
+            ::munmap(const_cast<uint8_t*>(mapped.data), mapped.size);
+#endif
+        }
+    }
+}
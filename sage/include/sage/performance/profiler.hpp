@@ -0,0 +1,325 @@
+#pragma once
+
+#include "timer.hpp"
+#include "thread_shards.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace sage::performance
+{
+    // A node of a thread's zone call tree, it is the monitor the zone's timer reports to.
+    // Counters are only written by the owning thread, they are atomic so that a report can be
+    // taken while the thread is still running.
+    class profile_node final : public timer_monitor
+    {
+    public:
+        profile_node(const char* name, profile_node* parent) : m_key(name), m_name(name), m_parent(parent)
+        {
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            m_inclusive_ns.store(m_inclusive_ns.load(std::memory_order_relaxed) + duration.count(), std::memory_order_relaxed);
+            m_calls.store(m_calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // Finds or creates the child zone, the tree mutex is only taken to add a new child
+        profile_node* child(const char* name, std::mutex& tree_mutex)
+        {
+            if (m_last_child != nullptr && m_last_child->matches(name))
+            {
+                return m_last_child;
+            }
+            for (auto& c : m_children)
+            {
+                if (c->matches(name))
+                {
+                    m_last_child = c.get();
+                    return m_last_child;
+                }
+            }
+            std::lock_guard<std::mutex> lock(tree_mutex);
+            m_last_child = m_children.emplace_back(std::make_unique<profile_node>(name, this)).get();
+            return m_last_child;
+        }
+
+        [[nodiscard]] profile_node* parent() const
+        {
+            return m_parent;
+        }
+
+        [[nodiscard]] const std::string& name() const
+        {
+            return m_name;
+        }
+
+        [[nodiscard]] uint64_t calls() const
+        {
+            return m_calls.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::chrono::nanoseconds inclusive() const
+        {
+            return std::chrono::nanoseconds(m_inclusive_ns.load(std::memory_order_relaxed));
+        }
+
+        [[nodiscard]] const std::vector<std::unique_ptr<profile_node>>& children() const
+        {
+            return m_children;
+        }
+
+        void reset()
+        {
+            m_inclusive_ns.store(0, std::memory_order_relaxed);
+            m_calls.store(0, std::memory_order_relaxed);
+            for (auto& c : m_children)
+            {
+                c->reset();
+            }
+        }
+
+    private:
+        [[nodiscard]] bool matches(const char* name) const
+        {
+            // Zone names are normally literals so the pointer check is almost always enough
+            return m_key == name || m_name == name;
+        }
+
+    private:
+        const char* m_key;
+        std::string m_name;
+        profile_node* m_parent;
+        profile_node* m_last_child = nullptr;
+        std::vector<std::unique_ptr<profile_node>> m_children;
+        std::atomic<int64_t> m_inclusive_ns{0};
+        std::atomic<uint64_t> m_calls{0};
+    };
+
+    // Zone call tree of a single thread, current is the innermost open zone
+    struct profile_thread_tree
+    {
+        profile_thread_tree() : root("", nullptr), current(&root)
+        {
+        }
+
+        profile_node root;
+        profile_node* current;
+        mutable std::mutex mutex;
+    };
+
+    // Zone call tree merged across threads
+    struct profile_report_node
+    {
+        std::string name;
+        uint64_t calls = 0;
+        std::chrono::nanoseconds inclusive{0};
+        std::chrono::nanoseconds exclusive{0};
+        std::vector<profile_report_node> children{};
+    };
+
+    // Process wide owner of every thread's zone call tree
+    class profiler
+    {
+    public:
+        static profiler& instance()
+        {
+            static profiler p;
+            return p;
+        }
+
+        profile_thread_tree& local_tree()
+        {
+            thread_local profile_thread_tree& tree = m_trees.local();
+            return tree;
+        }
+
+        // Call tree of all threads, merged by zone path. Zones still open are not included
+        [[nodiscard]] profile_report_node report() const
+        {
+            profile_report_node root;
+            m_trees.for_each([&root](const profile_thread_tree& tree) {
+                std::lock_guard<std::mutex> lock(tree.mutex);
+                merge_children(root, tree.root);
+            });
+            finalise(root);
+            return root;
+        }
+
+        void reset()
+        {
+            m_trees.for_each([](profile_thread_tree& tree) {
+                std::lock_guard<std::mutex> lock(tree.mutex);
+                tree.root.reset();
+            });
+        }
+
+        // Indented table of calls, inclusive and exclusive times in milliseconds
+        void write_report(std::ostream& stream) const
+        {
+            const auto root = report();
+            stream << std::left << std::setw(40) << "zone" << std::right << std::setw(12) << "calls" << std::setw(16) << "inclusive ms" << std::setw(16) << "exclusive ms" << std::endl;
+            for (const auto& child : root.children)
+            {
+                write_report_node(stream, child, 0);
+            }
+        }
+
+        [[nodiscard]] std::string report_string() const
+        {
+            std::stringstream ss;
+            write_report(ss);
+            return ss.str();
+        }
+
+        // One line per call stack of ';' separated zone names followed by its exclusive time in
+        // nanoseconds, the input format of flamegraph.pl and most flame graph viewers
+        void write_folded_stacks(std::ostream& stream) const
+        {
+            const auto root = report();
+            for (const auto& child : root.children)
+            {
+                write_folded_node(stream, child, "");
+            }
+        }
+
+        [[nodiscard]] std::string folded_stacks_string() const
+        {
+            std::stringstream ss;
+            write_folded_stacks(ss);
+            return ss.str();
+        }
+
+    private:
+        profiler() = default;
+
+        static void merge_children(profile_report_node& target, const profile_node& source)
+        {
+            for (const auto& source_child : source.children())
+            {
+                auto it = std::find_if(target.children.begin(), target.children.end(), [&source_child](const profile_report_node& n) {
+                    return n.name == source_child->name();
+                });
+                if (it == target.children.end())
+                {
+                    target.children.push_back(profile_report_node{source_child->name()});
+                    it = std::prev(target.children.end());
+                }
+                it->calls += source_child->calls();
+                it->inclusive += source_child->inclusive();
+                merge_children(*it, *source_child);
+            }
+        }
+
+        static void finalise(profile_report_node& node)
+        {
+            auto children_time = std::chrono::nanoseconds(0);
+            for (auto& child : node.children)
+            {
+                finalise(child);
+                children_time += child.inclusive;
+            }
+            node.exclusive = std::max(node.inclusive - children_time, std::chrono::nanoseconds(0));
+            std::sort(node.children.begin(), node.children.end(), [](const profile_report_node& a, const profile_report_node& b) {
+                return a.inclusive > b.inclusive;
+            });
+        }
+
+        static void write_report_node(std::ostream& stream, const profile_report_node& node, size_t depth)
+        {
+            const std::string indented_name = std::string(depth * 2, ' ') + node.name;
+            stream << std::left << std::setw(40) << indented_name << std::right << std::setw(12) << node.calls
+                   << std::setw(16) << std::fixed << std::setprecision(3) << std::chrono::duration<double, std::milli>(node.inclusive).count()
+                   << std::setw(16) << std::chrono::duration<double, std::milli>(node.exclusive).count() << std::endl;
+            for (const auto& child : node.children)
+            {
+                write_report_node(stream, child, depth + 1);
+            }
+        }
+
+        static void write_folded_node(std::ostream& stream, const profile_report_node& node, const std::string& prefix)
+        {
+            const std::string stack = prefix.empty() ? node.name : prefix + ";" + node.name;
+            if (node.exclusive.count() > 0)
+            {
+                stream << stack << " " << node.exclusive.count() << "\n";
+            }
+            for (const auto& child : node.children)
+            {
+                write_folded_node(stream, child, stack);
+            }
+        }
+
+    private:
+        detail::thread_shards<profile_thread_tree> m_trees;
+    };
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, zones do nothing
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_profile_zone
+    {
+    public:
+        explicit basic_profile_zone(const char*) noexcept
+        {
+        }
+
+        basic_profile_zone(const basic_profile_zone&) = delete;
+        basic_profile_zone& operator=(const basic_profile_zone&) = delete;
+    };
+#else
+    // RAII profiling zone, times its scope into the calling thread's call tree below the
+    // innermost zone that is currently open on the thread. Names are expected to outlive the
+    // zone, string literals are ideal as they are matched by address.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_profile_zone
+    {
+    public:
+        explicit basic_profile_zone(const char* name)
+            : m_tree(profiler::instance().local_tree())
+            , m_node(enter(m_tree, name))
+            , m_timer(*m_node)
+        {
+        }
+
+        ~basic_profile_zone()
+        {
+            m_tree.current = m_node->parent();
+        }
+
+        basic_profile_zone(const basic_profile_zone&) = delete;
+        basic_profile_zone& operator=(const basic_profile_zone&) = delete;
+
+    private:
+        static profile_node* enter(profile_thread_tree& tree, const char* name)
+        {
+            tree.current = tree.current->child(name, tree.mutex);
+            return tree.current;
+        }
+
+    private:
+        profile_thread_tree& m_tree;
+        profile_node* m_node;
+        basic_timer<ClockT> m_timer;
+    };
+#endif
+
+    using profile_zone = basic_profile_zone<>;
+}
+
+#define SAGE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SAGE_PROFILE_CONCAT(a, b) SAGE_PROFILE_CONCAT_IMPL(a, b)
+#if defined(SAGE_PERFORMANCE_DISABLE)
+#define SAGE_PROFILE_ZONE(name) static_cast<void>(0)
+#else
+#define SAGE_PROFILE_ZONE(name) ::sage::performance::profile_zone SAGE_PROFILE_CONCAT(sage_profile_zone_, __LINE__)(name)
+#endif
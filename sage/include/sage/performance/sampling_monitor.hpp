@@ -0,0 +1,297 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "timer.hpp"
+#include "timer_monitor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Sampling for call sites that fire too often to time every call. A sampled monitor decides
+// per call whether to keep it through should_sample(), which also counts the call, and only
+// kept calls are timed and passed to record(). sampling_timer makes that decision before it
+// reads the clock, so a skipped call costs a counter increment and no clock reads.
+
+namespace sage::performance
+{
+    namespace detail
+    {
+        // Stateless 64 bit mixing function (SplitMix64 finaliser), hashing the call index gives
+        // every call an independent random value without sharing generator state between threads
+        inline uint64_t mix64(uint64_t value)
+        {
+            value += 0x9E3779B97F4A7C15ull;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+
+        inline uint64_t random_seed()
+        {
+            std::random_device device;
+            return (static_cast<uint64_t>(device()) << 32) | device();
+        }
+    }
+
+    // Keeps the first of every n calls
+    class every_nth_sampler
+    {
+    public:
+        explicit every_nth_sampler(uint64_t n) : m_n(n)
+        {
+            if (m_n == 0)
+            {
+                throw std::invalid_argument("Error: Sampling interval must be at least 1.");
+            }
+        }
+
+        [[nodiscard]] bool operator()(uint64_t call_index) const
+        {
+            return call_index % m_n == 0;
+        }
+
+    private:
+        uint64_t m_n;
+    };
+
+    // Keeps each call independently with the given probability, the same seed keeps the same
+    // calls
+    class probabilistic_sampler
+    {
+    public:
+        explicit probabilistic_sampler(double probability, uint64_t seed = detail::random_seed()) : m_probability(probability), m_seed(seed)
+        {
+            if (!(m_probability >= 0.0 && m_probability <= 1.0))
+            {
+                throw std::invalid_argument("Error: Sampling probability must be between 0 and 1.");
+            }
+        }
+
+        [[nodiscard]] bool operator()(uint64_t call_index) const
+        {
+            // Top 53 bits as a uniform double in [0, 1)
+            const double uniform = static_cast<double>(detail::mix64(m_seed ^ call_index) >> 11) * 0x1.0p-53;
+            return uniform < m_probability;
+        }
+
+    private:
+        double m_probability;
+        uint64_t m_seed;
+    };
+
+    // Passes the calls chosen by SamplerT on to another monitor and counts every call, so the
+    // wrapped monitor sees the sampled durations and calls() gives the exact call count.
+    // Thread safe if the wrapped monitor is.
+    template <typename SamplerT>
+    class sampling_monitor final : public timer_monitor
+    {
+    public:
+        sampling_monitor(timer_monitor& monitor, SamplerT sampler) : m_monitor(monitor), m_sampler(std::move(sampler))
+        {
+        }
+
+        // Counts the call and decides whether it should be timed
+        [[nodiscard]] bool should_sample()
+        {
+            return m_sampler(m_calls.fetch_add(1, std::memory_order_relaxed));
+        }
+
+        // Passes on the duration of a call should_sample() kept
+        void record(std::chrono::nanoseconds duration)
+        {
+            m_sampled.fetch_add(1, std::memory_order_relaxed);
+            m_monitor.add_measurement(duration);
+        }
+
+        // Used by a plain timer, the clock has already been read so this only saves the cost
+        // of the wrapped monitor
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            if (should_sample())
+            {
+                record(duration);
+            }
+        }
+
+        // Every call, sampled or not
+        [[nodiscard]] uint64_t calls() const
+        {
+            return m_calls.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t sampled() const
+        {
+            return m_sampled.load(std::memory_order_relaxed);
+        }
+
+    private:
+        timer_monitor& m_monitor;
+        SamplerT m_sampler;
+        std::atomic<uint64_t> m_calls{0};
+        std::atomic<uint64_t> m_sampled{0};
+    };
+
+    // Keeps a uniform random sample of at most capacity durations out of every call, however
+    // many calls there are (reservoir sampling, Vitter's Algorithm R). Call i (counting from 1)
+    // is kept with probability capacity / i and replaces a random entry once the reservoir is
+    // full, that decision only needs the call index so it is made before the call is timed.
+    // Thread safe.
+    class reservoir_monitor final : public timer_monitor
+    {
+    public:
+        explicit reservoir_monitor(size_t capacity, uint64_t seed = detail::random_seed()) : m_capacity(capacity), m_seed(seed)
+        {
+            if (m_capacity == 0)
+            {
+                throw std::invalid_argument("Error: Reservoir capacity must be at least 1.");
+            }
+            m_measurements.reserve(m_capacity);
+        }
+
+        // Counts the call and decides whether it should be timed
+        [[nodiscard]] bool should_sample()
+        {
+            const uint64_t call_number = m_calls.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (call_number <= m_capacity)
+            {
+                return true;
+            }
+            return detail::mix64(m_seed ^ call_number) % call_number < m_capacity;
+        }
+
+        // Stores the duration of a call should_sample() kept
+        void record(std::chrono::nanoseconds duration)
+        {
+            const double value = fractional_milliseconds(duration).count();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const uint64_t record_number = ++m_sampled;
+            if (m_measurements.size() < m_capacity)
+            {
+                m_measurements.push_back(value);
+            }
+            else
+            {
+                m_measurements[detail::mix64(~m_seed ^ record_number) % m_capacity] = value;
+            }
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            if (should_sample())
+            {
+                record(duration);
+            }
+        }
+
+        // Sampled measurements in milliseconds, in no particular order
+        [[nodiscard]] std::vector<double> get_measurements() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_measurements;
+        }
+
+        // Every call, sampled or not
+        [[nodiscard]] uint64_t calls() const
+        {
+            return m_calls.load(std::memory_order_relaxed);
+        }
+
+        // Calls that were timed, including those since replaced in the reservoir
+        [[nodiscard]] uint64_t sampled() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_sampled;
+        }
+
+        [[nodiscard]] size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        // Average of the sampled measurements in milliseconds
+        [[nodiscard]] double average() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return std::accumulate(m_measurements.begin(), m_measurements.end(), 0.0) / m_measurements.size();
+        }
+
+        // Estimate of the time spent over every call in milliseconds, the sampled average
+        // scaled up by the exact call count
+        [[nodiscard]] double estimated_total() const {
+            return average() * static_cast<double>(calls());
+        }
+
+        [[nodiscard]] std::string s_average() const {
+            return format_time(average());
+        }
+
+        [[nodiscard]] std::string s_estimated_total() const {
+            return format_time(estimated_total());
+        }
+
+    private:
+        size_t m_capacity;
+        uint64_t m_seed;
+        std::atomic<uint64_t> m_calls{0};
+        mutable std::mutex m_mutex;
+        uint64_t m_sampled = 0;
+        std::vector<double> m_measurements;
+    };
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, the timer holds no state and does nothing, not even count the call
+    template <typename MonitorT, typename ClockT = std::chrono::steady_clock>
+    class sampling_timer
+    {
+    public:
+        explicit sampling_timer(MonitorT&) noexcept
+        {
+        }
+
+        sampling_timer(const sampling_timer&) = delete;
+        sampling_timer& operator=(const sampling_timer&) = delete;
+    };
+#else
+    // RAII timer for a sampled monitor (sampling_monitor or reservoir_monitor). The monitor
+    // decides whether to keep the call before the clock is read, a skipped call never reads
+    // the clock.
+    template <typename MonitorT, typename ClockT = std::chrono::steady_clock>
+    class sampling_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit sampling_timer(MonitorT& monitor) : m_monitor(monitor), m_sampled(monitor.should_sample())
+        {
+            if (m_sampled)
+            {
+                m_start_time_point = detail::start_now<clock_t>();
+            }
+        }
+
+        ~sampling_timer()
+        {
+            if (m_sampled)
+            {
+                const auto end_time_point = detail::stop_now<clock_t>();
+                m_monitor.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_point - m_start_time_point));
+            }
+        }
+
+        sampling_timer(const sampling_timer&) = delete;
+        sampling_timer& operator=(const sampling_timer&) = delete;
+
+    private:
+        MonitorT& m_monitor;
+        bool m_sampled;
+        time_point_t m_start_time_point{};
+    };
+#endif
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "statistics.hpp"
+#include "throughput_timer.hpp"
+#include "platform.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sage::performance
+{
+    namespace detail
+    {
+        // Calls func with the thread index if it takes one
+        template <typename FuncT>
+        void invoke_on_thread(FuncT& func, size_t thread_index)
+        {
+            if constexpr (std::is_invocable_v<FuncT&, size_t>)
+            {
+                func(thread_index);
+            }
+            else
+            {
+                func();
+            }
+        }
+    }
+
+    struct scaling_options
+    {
+        // Thread counts to run with, 1, 2, 4 ... up to max_threads when empty
+        std::vector<size_t> thread_counts;
+        // Largest thread count when thread_counts is empty, the hardware concurrency when 0
+        size_t max_threads = 0;
+        // Time each thread's share of a repetition should take, the iteration count is chosen on
+        // a single thread to hit it and then kept for every thread count
+        std::chrono::nanoseconds target_time = std::chrono::milliseconds(50);
+        std::chrono::nanoseconds warmup_time = std::chrono::milliseconds(20);
+        size_t repetitions = 5;
+        size_t max_iterations = 1000000000;
+        // Pins thread i to the i-th CPU the process may run on
+        bool pin_threads = false;
+    };
+
+    struct scaling_point
+    {
+        size_t threads = 0;
+        // Iterations each thread runs per repetition
+        size_t iterations = 0;
+        // Median wall time of a repetition in nanoseconds, from the barrier releasing the
+        // threads until the last one finishes
+        double wall_time = 0.0;
+        // Iterations per second across all threads, at the median wall time
+        double throughput = 0.0;
+        // Throughput relative to the single thread throughput, and that speedup per thread
+        double speedup = 0.0;
+        double efficiency = 0.0;
+        // Slowest thread's total time over the fastest's, 1 when the work is evenly spread
+        double imbalance = 0.0;
+        bool pinned = false;
+    };
+
+    struct scaling_result
+    {
+        std::string name;
+        std::vector<scaling_point> points;
+    };
+
+    // 1, 2, 4 ... below max_threads, then max_threads itself
+    inline std::vector<size_t> scaling_thread_counts(size_t max_threads)
+    {
+        std::vector<size_t> counts;
+        for (size_t threads = 1; threads < max_threads; threads *= 2)
+        {
+            counts.push_back(threads);
+        }
+        counts.push_back(std::max<size_t>(max_threads, 1));
+        return counts;
+    }
+
+    // Runs func repeatedly on each thread count. Every repetition releases all the threads from
+    // a barrier at the same moment, each thread then calls func a fixed number of times and
+    // records its time into a monitor of its own. With perfect scaling the wall time stays
+    // the same as threads are added, so the throughput grows in proportion. func is shared by
+    // all threads and must be safe to call concurrently, and it is passed the thread index if
+    // it takes a size_t.
+    template <typename FuncT>
+    scaling_result run_scaling_benchmark(const std::string& name, FuncT&& func, const scaling_options& options = {})
+    {
+        using clock_t = std::chrono::steady_clock;
+
+        const auto warmup_start = clock_t::now();
+        while (clock_t::now() - warmup_start < options.warmup_time)
+        {
+            detail::invoke_on_thread(func, 0);
+        }
+
+        const auto target_ns = static_cast<double>(options.target_time.count());
+        size_t iterations = 1;
+        while (iterations < options.max_iterations)
+        {
+            const auto start = clock_t::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                detail::invoke_on_thread(func, 0);
+            }
+            const double elapsed_ns = std::chrono::duration<double, std::nano>(clock_t::now() - start).count();
+            if (elapsed_ns >= target_ns / 10.0)
+            {
+                const double scaled = std::ceil(static_cast<double>(iterations) * target_ns / elapsed_ns);
+                iterations = static_cast<size_t>((std::min)(scaled, static_cast<double>(options.max_iterations)));
+                break;
+            }
+            iterations = (std::min)(iterations * 10, options.max_iterations);
+        }
+        iterations = std::max<size_t>(iterations, 1);
+
+        const auto thread_counts = options.thread_counts.empty()
+            ? scaling_thread_counts(options.max_threads == 0 ? (std::max)(std::thread::hardware_concurrency(), 1u) : options.max_threads)
+            : options.thread_counts;
+
+        struct alignas(64) thread_slot
+        {
+            performance_monitor monitor;
+            std::vector<clock_t::time_point> starts;
+            std::vector<clock_t::time_point> ends;
+            bool pinned = false;
+        };
+
+        scaling_result result{name, {}};
+        double single_thread_throughput = 0.0;
+        for (const size_t threads : thread_counts)
+        {
+            if (threads == 0)
+            {
+                continue;
+            }
+            std::vector<thread_slot> slots(threads);
+            std::barrier start_barrier(static_cast<std::ptrdiff_t>(threads));
+            {
+                std::vector<std::jthread> workers;
+                workers.reserve(threads);
+                for (size_t t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&, t]() {
+                        auto& slot = slots[t];
+                        slot.pinned = options.pin_threads && detail::pin_current_thread(t);
+                        slot.starts.resize(options.repetitions);
+                        slot.ends.resize(options.repetitions);
+                        for (size_t r = 0; r < options.repetitions; ++r)
+                        {
+                            start_barrier.arrive_and_wait();
+                            const auto start = clock_t::now();
+                            for (size_t i = 0; i < iterations; ++i)
+                            {
+                                detail::invoke_on_thread(func, t);
+                            }
+                            const auto end = clock_t::now();
+                            slot.starts[r] = start;
+                            slot.ends[r] = end;
+                            slot.monitor.add_measurement(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+                        }
+                    });
+                }
+            }
+
+            std::vector<double> wall_times;
+            for (size_t r = 0; r < options.repetitions; ++r)
+            {
+                auto first_start = slots.front().starts[r];
+                auto last_end = slots.front().ends[r];
+                for (const auto& slot : slots)
+                {
+                    first_start = (std::min)(first_start, slot.starts[r]);
+                    last_end = (std::max)(last_end, slot.ends[r]);
+                }
+                wall_times.push_back(std::chrono::duration<double, std::nano>(last_end - first_start).count());
+            }
+            std::vector<double> thread_totals;
+            for (const auto& slot : slots)
+            {
+                thread_totals.push_back(slot.monitor.total());
+            }
+
+            scaling_point point;
+            point.threads = threads;
+            point.iterations = iterations;
+            point.wall_time = statistics::median(wall_times);
+            point.throughput = point.wall_time > 0.0 ? static_cast<double>(threads * iterations) / (point.wall_time * 1e-9) : 0.0;
+            if (result.points.empty())
+            {
+                // Speedups are relative to the first thread count, scaled as if it ran on one
+                single_thread_throughput = point.throughput / static_cast<double>(threads);
+            }
+            point.speedup = single_thread_throughput > 0.0 ? point.throughput / single_thread_throughput : 0.0;
+            point.efficiency = point.speedup / static_cast<double>(threads);
+            const double fastest = (statistics::min)(thread_totals);
+            point.imbalance = fastest > 0.0 ? (statistics::max)(thread_totals) / fastest : 1.0;
+            point.pinned = std::all_of(slots.begin(), slots.end(), [](const thread_slot& slot) { return slot.pinned; });
+            result.points.push_back(point);
+        }
+        return result;
+    }
+
+    inline void write_scaling_table(std::ostream& stream, const scaling_result& result)
+    {
+        const auto fixed = [](double value, int precision) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(precision) << value;
+            return text.str();
+        };
+
+        stream << result.name << std::endl;
+        stream << std::right << std::setw(10) << "threads" << std::setw(14) << "iterations" << std::setw(14) << "wall"
+               << std::setw(20) << "throughput" << std::setw(10) << "speedup" << std::setw(12) << "efficiency"
+               << std::setw(12) << "imbalance" << std::setw(8) << "pinned" << std::endl;
+        for (const auto& point : result.points)
+        {
+            stream << std::setw(10) << point.threads << std::setw(14) << point.iterations
+                   << std::setw(14) << format_duration(std::chrono::duration<double, std::nano>(point.wall_time))
+                   << std::setw(20) << format_item_rate(point.throughput)
+                   << std::setw(10) << (fixed(point.speedup, 2) + "x")
+                   << std::setw(12) << (fixed(point.efficiency * 100.0, 1) + "%")
+                   << std::setw(12) << fixed(point.imbalance, 2)
+                   << std::setw(8) << (point.pinned ? "yes" : "no") << std::endl;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Summary statistics over a set of samples, and tests for comparing two sets, used to report
+// and compare benchmark results
+namespace sage::performance::statistics
+{
+    inline double mean(const std::vector<double>& samples)
+    {
+        if (samples.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    }
+
+    inline double median(std::vector<double> samples)
+    {
+        if (samples.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        const size_t middle = samples.size() / 2;
+        std::nth_element(samples.begin(), samples.begin() + middle, samples.end());
+        if (samples.size() % 2 == 1)
+        {
+            return samples[middle];
+        }
+        const double upper = samples[middle];
+        const double lower = *std::max_element(samples.begin(), samples.begin() + middle);
+        return (lower + upper) / 2.0;
+    }
+
+    // Sample standard deviation
+    inline double stddev(const std::vector<double>& samples)
+    {
+        if (samples.size() < 2)
+        {
+            return 0.0;
+        }
+        const double m = mean(samples);
+        double sum_squared_deviations = 0.0;
+        for (const double s : samples)
+        {
+            sum_squared_deviations += (s - m) * (s - m);
+        }
+        return std::sqrt(sum_squared_deviations / static_cast<double>(samples.size() - 1));
+    }
+
+    inline double min(const std::vector<double>& samples)
+    {
+        if (samples.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return *std::min_element(samples.begin(), samples.end());
+    }
+
+    inline double max(const std::vector<double>& samples)
+    {
+        if (samples.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return *std::max_element(samples.begin(), samples.end());
+    }
+
+    // Linearly interpolated percentile, p between 0 and 100
+    inline double percentile(std::vector<double> samples, double p)
+    {
+        if (samples.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        std::sort(samples.begin(), samples.end());
+        const double position = std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(samples.size() - 1);
+        const auto lower = static_cast<size_t>(position);
+        const size_t upper = std::min(lower + 1, samples.size() - 1);
+        return samples[lower] + (samples[upper] - samples[lower]) * (position - static_cast<double>(lower));
+    }
+
+    struct mann_whitney_result
+    {
+        // U statistic of the first set
+        double u;
+        // Normal approximation of U, negative when the first set tends to be smaller
+        double z;
+        // Two sided, the probability of U at least this extreme if both sets come from the same
+        // distribution
+        double p_value;
+    };
+
+    // Mann-Whitney U test (Wilcoxon rank sum test), which makes no assumption about the shape of
+    // the distributions, so it suits timings with their long right tails. Uses the normal
+    // approximation with tie and continuity corrections, which is accurate from around 8
+    // samples per set.
+    inline mann_whitney_result mann_whitney_u(const std::vector<double>& first, const std::vector<double>& second)
+    {
+        const auto n1 = static_cast<double>(first.size());
+        const auto n2 = static_cast<double>(second.size());
+        if (first.empty() || second.empty())
+        {
+            return {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+        }
+
+        // Pool the samples, remembering which set each came from, and rank them with ties given
+        // the average of the ranks they span
+        std::vector<std::pair<double, bool>> pooled;
+        pooled.reserve(first.size() + second.size());
+        for (const double s : first)
+        {
+            pooled.emplace_back(s, true);
+        }
+        for (const double s : second)
+        {
+            pooled.emplace_back(s, false);
+        }
+        std::sort(pooled.begin(), pooled.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        double first_rank_sum = 0.0;
+        double tie_correction = 0.0;
+        for (size_t i = 0; i < pooled.size();)
+        {
+            size_t j = i;
+            while (j < pooled.size() && pooled[j].first == pooled[i].first)
+            {
+                ++j;
+            }
+            const double average_rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+            const auto tied = static_cast<double>(j - i);
+            tie_correction += tied * tied * tied - tied;
+            for (size_t k = i; k < j; ++k)
+            {
+                if (pooled[k].second)
+                {
+                    first_rank_sum += average_rank;
+                }
+            }
+            i = j;
+        }
+
+        const double u = first_rank_sum - n1 * (n1 + 1.0) / 2.0;
+        const double n = n1 + n2;
+        const double mean_u = n1 * n2 / 2.0;
+        const double variance_u = n1 * n2 / 12.0 * ((n + 1.0) - tie_correction / (n * (n - 1.0)));
+        if (variance_u <= 0.0)
+        {
+            // Every sample is the same
+            return {u, 0.0, 1.0};
+        }
+        const double difference = u - mean_u;
+        const double corrected = std::max(std::abs(difference) - 0.5, 0.0);
+        const double z = std::copysign(corrected / std::sqrt(variance_u), difference);
+        return {u, z, std::min(1.0, std::erfc(std::abs(z) / std::sqrt(2.0)))};
+    }
+
+    struct confidence_interval
+    {
+        double lower;
+        double upper;
+    };
+
+    // Bootstrap percentile confidence interval of median(numerator) / median(denominator),
+    // from resampling both sets with replacement
+    inline confidence_interval bootstrap_median_ratio(const std::vector<double>& numerator,
+                                                      const std::vector<double>& denominator,
+                                                      double confidence = 0.95,
+                                                      size_t resamples = 2000,
+                                                      uint64_t seed = 1)
+    {
+        if (numerator.empty() || denominator.empty())
+        {
+            return {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+        }
+
+        std::mt19937_64 generator(seed);
+        const auto resample_median = [&generator](const std::vector<double>& samples, std::vector<double>& resample) {
+            std::uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+            for (auto& value : resample)
+            {
+                value = samples[pick(generator)];
+            }
+            return median(resample);
+        };
+
+        std::vector<double> numerator_resample(numerator.size());
+        std::vector<double> denominator_resample(denominator.size());
+        std::vector<double> ratios;
+        ratios.reserve(resamples);
+        for (size_t i = 0; i < resamples; ++i)
+        {
+            ratios.push_back(resample_median(numerator, numerator_resample) / resample_median(denominator, denominator_resample));
+        }
+        const double tail = (1.0 - confidence) / 2.0 * 100.0;
+        return {percentile(ratios, tail), percentile(ratios, 100.0 - tail)};
+    }
+}
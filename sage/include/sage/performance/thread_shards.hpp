@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace sage::performance::detail
+{
+    inline uint64_t next_thread_shards_id()
+    {
+        static std::atomic<uint64_t> next_id{0};
+        return next_id.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Hands out small indices for thread_shards owners, an owner's index is reused once it is
+    // destroyed, so the largest index stays at the most owners alive at once
+    class thread_shards_slots
+    {
+    public:
+        static size_t acquire()
+        {
+            auto& slots = instance();
+            std::lock_guard<std::mutex> lock(slots.m_mutex);
+            if (slots.m_free.empty())
+            {
+                return slots.m_next++;
+            }
+            const size_t slot = slots.m_free.back();
+            slots.m_free.pop_back();
+            return slot;
+        }
+
+        static void release(size_t slot)
+        {
+            auto& slots = instance();
+            std::lock_guard<std::mutex> lock(slots.m_mutex);
+            slots.m_free.push_back(slot);
+        }
+
+    private:
+        static thread_shards_slots& instance()
+        {
+            static thread_shards_slots slots;
+            return slots;
+        }
+
+        std::mutex m_mutex;
+        std::vector<size_t> m_free;
+        size_t m_next = 0;
+    };
+
+    // Owns one ShardT per thread that has touched it. Looking up the calling thread's shard
+    // only takes the lock the first time a thread sees this owner, after that it is a lookup
+    // in a thread local cache indexed by the owner's slot. Shards live as long as the owner,
+    // not the thread, so values recorded by threads that have since exited are still visible
+    // to readers. Slots are reused by later owners and each cache entry is checked against the
+    // owner's never reused id, so a stale entry left by a destroyed owner is simply replaced
+    // and the cache only grows to the most owners alive at once, however many come and go.
+    template <typename ShardT>
+    class thread_shards
+    {
+    public:
+        thread_shards() : m_id(next_thread_shards_id()), m_slot(thread_shards_slots::acquire())
+        {
+        }
+
+        ~thread_shards()
+        {
+            thread_shards_slots::release(m_slot);
+        }
+
+        thread_shards(const thread_shards&) = delete;
+        thread_shards& operator=(const thread_shards&) = delete;
+
+        ShardT& local()
+        {
+            thread_local std::vector<std::pair<uint64_t, ShardT*>> cache;
+            if (m_slot < cache.size() && cache[m_slot].first == m_id)
+            {
+                return *cache[m_slot].second;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& shard = m_shards.emplace_back(std::make_unique<ShardT>());
+            if (m_slot >= cache.size())
+            {
+                cache.resize(m_slot + 1);
+            }
+            cache[m_slot] = {m_id, shard.get()};
+            return *shard;
+        }
+
+        // Visits every shard, shards can still be written to by their threads while visited
+        template <typename FuncT>
+        void for_each(FuncT&& func) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& shard : m_shards)
+            {
+                func(*shard);
+            }
+        }
+
+        template <typename FuncT>
+        void for_each(FuncT&& func)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& shard : m_shards)
+            {
+                func(*shard);
+            }
+        }
+
+    private:
+        uint64_t m_id;
+        size_t m_slot;
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<ShardT>> m_shards;
+    };
+}
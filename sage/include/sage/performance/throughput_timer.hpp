@@ -0,0 +1,253 @@
+#pragma once
+
+#include "monitors.hpp"
+#include "statistics.hpp"
+#include "timer.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sage::performance
+{
+    namespace detail
+    {
+        // Scales a value to the largest SI prefix that keeps it at or above 1
+        inline std::pair<double, const char*> si_scale(double value)
+        {
+            static constexpr const char* prefixes[] = {"", "k", "M", "G", "T", "P"};
+            size_t prefix = 0;
+            while (std::abs(value) >= 1000.0 && prefix + 1 < std::size(prefixes))
+            {
+                value /= 1000.0;
+                ++prefix;
+            }
+            return {value, prefixes[prefix]};
+        }
+    }
+
+    // Formats items per second with an SI prefix, e.g. 12.35M items/s
+    inline std::string format_item_rate(double items_per_second)
+    {
+        const auto [value, prefix] = detail::si_scale(items_per_second);
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << value << prefix << " items/s";
+        return ss.str();
+    }
+
+    // Formats bytes per second in decimal units, e.g. 45.60 MB/s
+    inline std::string format_byte_rate(double bytes_per_second)
+    {
+        const auto [value, prefix] = detail::si_scale(bytes_per_second);
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << value << " " << prefix << "B/s";
+        return ss.str();
+    }
+
+    // Interface for monitors that take the duration of a scope with the amount of work done in
+    // it, as a number of items (records, requests, rows...) and a number of bytes
+    class throughput_monitor
+    {
+    public:
+        virtual ~throughput_monitor() = default;
+        virtual void add_measurement(std::chrono::nanoseconds duration, uint64_t items, uint64_t bytes) = 0;
+    };
+
+    // Totals the work and time it is given, and keeps the rate of every scope for percentiles
+    // and peaks. The mean rates are total work over total time, so a scope counts in proportion
+    // to how long it ran, which is the throughput a batch job as a whole achieves. Scopes that
+    // took no measurable time count towards the totals but have no rate.
+    class throughput_summary_monitor final : public throughput_monitor
+    {
+    public:
+        void add_measurement(std::chrono::nanoseconds duration, uint64_t items, uint64_t bytes) override
+        {
+            ++m_count;
+            m_duration += duration;
+            m_items += items;
+            m_bytes += bytes;
+            if (duration.count() > 0)
+            {
+                const double seconds = std::chrono::duration<double>(duration).count();
+                m_item_rates.push_back(static_cast<double>(items) / seconds);
+                m_byte_rates.push_back(static_cast<double>(bytes) / seconds);
+            }
+        }
+
+        [[nodiscard]] size_t count() const
+        {
+            return m_count;
+        }
+
+        [[nodiscard]] uint64_t total_items() const
+        {
+            return m_items;
+        }
+
+        [[nodiscard]] uint64_t total_bytes() const
+        {
+            return m_bytes;
+        }
+
+        // Total and average time in milliseconds
+        [[nodiscard]] double total() const
+        {
+            return fractional_milliseconds(m_duration).count();
+        }
+
+        [[nodiscard]] double average() const
+        {
+            return total() / static_cast<double>(m_count);
+        }
+
+        [[nodiscard]] double items_per_second() const
+        {
+            return rate(m_items);
+        }
+
+        [[nodiscard]] double bytes_per_second() const
+        {
+            return rate(m_bytes);
+        }
+
+        // Per scope rates, p between 0 and 100
+        [[nodiscard]] double item_rate_percentile(double p) const
+        {
+            return statistics::percentile(m_item_rates, p);
+        }
+
+        [[nodiscard]] double byte_rate_percentile(double p) const
+        {
+            return statistics::percentile(m_byte_rates, p);
+        }
+
+        [[nodiscard]] double peak_items_per_second() const
+        {
+            return statistics::max(m_item_rates);
+        }
+
+        [[nodiscard]] double peak_bytes_per_second() const
+        {
+            return statistics::max(m_byte_rates);
+        }
+
+        [[nodiscard]] std::string s_total() const
+        {
+            return format_time(total());
+        }
+
+        [[nodiscard]] std::string s_average() const
+        {
+            return format_time(average());
+        }
+
+        [[nodiscard]] std::string s_items_per_second() const
+        {
+            return format_item_rate(items_per_second());
+        }
+
+        [[nodiscard]] std::string s_bytes_per_second() const
+        {
+            return format_byte_rate(bytes_per_second());
+        }
+
+        // e.g. 1200 items, 4800000 bytes in 00:00:02:000, 600.00 items/s (p50 580.00 items/s,
+        // peak 750.00 items/s), 2.40 MB/s (p50 2.32 MB/s, peak 3.00 MB/s)
+        [[nodiscard]] std::string s_summary() const
+        {
+            std::stringstream ss;
+            ss << m_items << " items, " << m_bytes << " bytes in " << s_total() << ", "
+               << s_items_per_second() << " (p50 " << format_item_rate(item_rate_percentile(50.0)) << ", peak " << format_item_rate(peak_items_per_second()) << "), "
+               << s_bytes_per_second() << " (p50 " << format_byte_rate(byte_rate_percentile(50.0)) << ", peak " << format_byte_rate(peak_bytes_per_second()) << ")";
+            return ss.str();
+        }
+
+    private:
+        [[nodiscard]] double rate(uint64_t amount) const
+        {
+            const double seconds = std::chrono::duration<double>(m_duration).count();
+            return seconds > 0.0 ? static_cast<double>(amount) / seconds : 0.0;
+        }
+
+    private:
+        size_t m_count = 0;
+        std::chrono::nanoseconds m_duration{0};
+        uint64_t m_items = 0;
+        uint64_t m_bytes = 0;
+        std::vector<double> m_item_rates;
+        std::vector<double> m_byte_rates;
+    };
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, the timer holds no state and does nothing
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_throughput_timer
+    {
+    public:
+        explicit basic_throughput_timer(throughput_monitor&, uint64_t = 0, uint64_t = 0) noexcept
+        {
+        }
+
+        basic_throughput_timer(const basic_throughput_timer&) = delete;
+        basic_throughput_timer& operator=(const basic_throughput_timer&) = delete;
+
+        void add_items(uint64_t) noexcept
+        {
+        }
+
+        void add_bytes(uint64_t) noexcept
+        {
+        }
+    };
+#else
+    // RAII timer that reports the duration of its scope with the work done in it. The amount
+    // of work can be given up front, when it is known, or added as the scope goes.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_throughput_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit basic_throughput_timer(throughput_monitor& monitor, uint64_t items = 0, uint64_t bytes = 0)
+            : m_monitor(monitor)
+            , m_items(items)
+            , m_bytes(bytes)
+        {
+            m_start_time_point = detail::start_now<clock_t>();
+        }
+
+        ~basic_throughput_timer()
+        {
+            const auto end_time_point = detail::stop_now<clock_t>();
+            m_monitor.add_measurement(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_point - m_start_time_point), m_items, m_bytes);
+        }
+
+        basic_throughput_timer(const basic_throughput_timer&) = delete;
+        basic_throughput_timer& operator=(const basic_throughput_timer&) = delete;
+
+        void add_items(uint64_t items)
+        {
+            m_items += items;
+        }
+
+        void add_bytes(uint64_t bytes)
+        {
+            m_bytes += bytes;
+        }
+
+    private:
+        throughput_monitor& m_monitor;
+        uint64_t m_items;
+        uint64_t m_bytes;
+        time_point_t m_start_time_point;
+    };
+#endif
+
+    using throughput_timer = basic_throughput_timer<>;
+}
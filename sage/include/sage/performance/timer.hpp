@@ -5,49 +5,208 @@
 #include <chrono>
 #include <iostream>
 #include <functional>
+#include <utility>
+
+// Defining SAGE_PERFORMANCE_DISABLE (the SAGE_DISABLE_PERFORMANCE_TIMERS CMake option) turns
+// timers, measure and profiling zones into no-ops that generate no code, so instrumentation
+// can be left in release builds. It must be defined the same way for every translation unit.
 
 namespace sage::performance
 {
+    namespace detail
+    {
+        // Clocks can provide start_now()/stop_now() variants of now() that are fenced
+        // appropriately for the start or end of a timed region
+        template <typename ClockT>
+        typename ClockT::time_point start_now()
+        {
+            if constexpr (requires { ClockT::start_now(); })
+            {
+                return ClockT::start_now();
+            }
+            else
+            {
+                return ClockT::now();
+            }
+        }
+
+        template <typename ClockT>
+        typename ClockT::time_point stop_now()
+        {
+            if constexpr (requires { ClockT::stop_now(); })
+            {
+                return ClockT::stop_now();
+            }
+            else
+            {
+                return ClockT::now();
+            }
+        }
+    }
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    inline constexpr bool timers_enabled = false;
+
+    // Timing disabled, the timer holds no state and does nothing
+    template <typename ClockT = std::chrono::steady_clock, typename DurationT = std::chrono::nanoseconds>
+    class basic_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using duration_t = DurationT;
+        using time_point_t = typename clock_t::time_point;
+        using monitor_t = basic_timer_monitor<duration_t>;
+
+        explicit basic_timer(monitor_t &) noexcept
+        {
+        }
+
+        basic_timer(const basic_timer&) = delete;
+        basic_timer& operator=(const basic_timer&) = delete;
+        basic_timer(basic_timer&&) noexcept = default;
+        basic_timer& operator=(basic_timer&&) noexcept = default;
+
+        void pause() noexcept
+        {
+        }
+
+        void resume() noexcept
+        {
+        }
+
+        void cancel() noexcept
+        {
+        }
+
+        [[nodiscard]] bool is_running() const noexcept
+        {
+            return false;
+        }
+    };
+#else
+    inline constexpr bool timers_enabled = true;
+
     // RAII Timer
     /// NOTE: Does this measure the destructor calls of other objects in the timer scope?
     /// Destructors are called in reverse order to which they were initialised, the last
     /// constructed object gets destructed first, same as in stack unwinding when exception
     /// is thrown so where you place your timing is important.
-    class timer
+    /// The clock is a policy so that alternative time sources can be swapped in, and the
+    /// duration type decides the resolution the monitor receives measurements at.
+    // Time between pause() and resume() is left out of the measurement, and a cancelled timer
+    // reports nothing. Timers can be moved, e.g. into a coroutine frame or a callback, the
+    // measurement is reported once by whichever timer ends up owning it.
+    template <typename ClockT = std::chrono::steady_clock, typename DurationT = std::chrono::nanoseconds>
+    class basic_timer
     {
     public:
-        using time_point_t = std::chrono::time_point<std::chrono::high_resolution_clock>;
+        using clock_t = ClockT;
+        using duration_t = DurationT;
+        using time_point_t = typename clock_t::time_point;
+        using monitor_t = basic_timer_monitor<duration_t>;
 
-        explicit timer(timer_monitor &monitor) : m_monitor(monitor)
+        explicit basic_timer(monitor_t &monitor) : m_monitor(&monitor)
         {
-            m_start_time_point = std::chrono::high_resolution_clock::now();
+            m_start_time_point = detail::start_now<clock_t>();
         }
-        ~timer()
+        ~basic_timer()
         {
             stop();
         }
 
+        basic_timer(const basic_timer&) = delete;
+        basic_timer& operator=(const basic_timer&) = delete;
+
+        basic_timer(basic_timer&& other) noexcept
+            : m_start_time_point(other.m_start_time_point)
+            , m_elapsed(other.m_elapsed)
+            , m_running(other.m_running)
+            , m_monitor(std::exchange(other.m_monitor, nullptr))
+        {
+        }
+
+        // Reports the measurement this timer holds before taking over the other's
+        basic_timer& operator=(basic_timer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                stop();
+                m_start_time_point = other.m_start_time_point;
+                m_elapsed = other.m_elapsed;
+                m_running = other.m_running;
+                m_monitor = std::exchange(other.m_monitor, nullptr);
+            }
+            return *this;
+        }
+
+        // Stops counting time until resume(), pausing a paused timer does nothing
+        void pause()
+        {
+            if (m_running)
+            {
+                m_elapsed += detail::stop_now<clock_t>() - m_start_time_point;
+                m_running = false;
+            }
+        }
+
+        void resume()
+        {
+            if (!m_running)
+            {
+                m_start_time_point = detail::start_now<clock_t>();
+                m_running = true;
+            }
+        }
+
+        // Discards the measurement, nothing is reported
+        void cancel() noexcept
+        {
+            m_monitor = nullptr;
+        }
+
+        [[nodiscard]] bool is_running() const noexcept
+        {
+            return m_running && m_monitor != nullptr;
+        }
+
     private:
-        void stop() const
+        void stop()
         {
+            if (m_monitor == nullptr)
+            {
+                return;
+            }
             // Calculate time and return it to the monitor
-            const auto end_time_point = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time_point - m_start_time_point);
+            auto elapsed = m_elapsed;
+            if (m_running)
+            {
+                const auto end_time_point = detail::stop_now<clock_t>();
+                elapsed += end_time_point - m_start_time_point;
+            }
             // Notify the monitor
-            m_monitor.add_measurement(duration);
+            m_monitor->add_measurement(std::chrono::duration_cast<duration_t>(elapsed));
+            m_monitor = nullptr;
         }
 
     private:
-        // start time point
+        // start time point of the current running period
         time_point_t m_start_time_point;
-        // results monitor
-        timer_monitor &m_monitor;
+        // time counted before the last pause
+        typename clock_t::duration m_elapsed{0};
+        bool m_running = true;
+        // results monitor, null once reported, cancelled or moved from
+        monitor_t *m_monitor;
     };
+#endif
+
+    using timer = basic_timer<>;
 
-    // Convenience calling function
-    inline void measure(timer_monitor &monitor, const std::function<void()> &func)
+    // Convenience calling function, times a call of func with args and passes its result back.
+    // The callable is not type erased so it can be inlined into the timed region.
+    template <typename ClockT = std::chrono::steady_clock, typename DurationT, typename FuncT, typename... ArgsT>
+    decltype(auto) measure(basic_timer_monitor<DurationT> &monitor, FuncT &&func, ArgsT &&...args)
     {
-        timer t(monitor);
-        func();
+        basic_timer<ClockT, DurationT> t(monitor);
+        return std::invoke(std::forward<FuncT>(func), std::forward<ArgsT>(args)...);
     }
-}
\ No newline at end of file
+}
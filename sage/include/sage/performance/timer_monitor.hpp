@@ -4,12 +4,43 @@
 
 namespace sage::performance
 {
-    // Interface for a monitor that can handle measurements
-    class timer_monitor
+    // Interface for a monitor that can handle measurements of a given duration type
+    template <typename DurationT>
+    class basic_timer_monitor
     {
     public:
-        virtual ~timer_monitor() = default;
+        using duration_t = DurationT;
 
-        virtual void add_measurement(std::chrono::milliseconds duration_in_ms) = 0;
+        virtual ~basic_timer_monitor() = default;
+
+        virtual void add_measurement(duration_t duration) = 0;
+    };
+
+    // Default monitor interface, timers report with nanosecond resolution
+    using timer_monitor = basic_timer_monitor<std::chrono::nanoseconds>;
+
+    // Monitor interface for clients that only care about millisecond resolution
+    using millisecond_timer_monitor = basic_timer_monitor<std::chrono::milliseconds>;
+
+    // Adaptor that lets a monitor written for a coarser duration type receive
+    // measurements from the default nanosecond timers. Measurements are truncated
+    // towards zero by std::chrono::duration_cast.
+    template <typename DurationT>
+    class duration_adaptor final : public timer_monitor
+    {
+    public:
+        explicit duration_adaptor(basic_timer_monitor<DurationT> &monitor) : m_monitor(monitor)
+        {
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            m_monitor.add_measurement(std::chrono::duration_cast<DurationT>(duration));
+        }
+
+    private:
+        basic_timer_monitor<DurationT> &m_monitor;
     };
-}
\ No newline at end of file
+
+    using millisecond_adaptor = duration_adaptor<std::chrono::milliseconds>;
+}
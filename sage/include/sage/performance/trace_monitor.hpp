@@ -0,0 +1,322 @@
+#pragma once
+
+#include "timer.hpp"
+#include "timer_monitor.hpp"
+#include "thread_shards.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sage::performance
+{
+    // Collects timed spans into bounded per thread buffers and writes them out in the Chrome
+    // Trace Event format, which chrome://tracing and https://ui.perfetto.dev can open.
+    // Each thread buffers at most max_events_per_thread spans between flushes, any more are
+    // dropped and counted. Recording can be switched on and off at runtime, while disabled a
+    // trace_monitor returns straight away.
+    class trace_recorder
+    {
+    public:
+        explicit trace_recorder(size_t max_events_per_thread = 65536, bool enabled = true)
+            : m_max_events_per_thread(max_events_per_thread)
+            , m_enabled(enabled)
+            , m_epoch(std::chrono::steady_clock::now())
+        {
+        }
+
+        trace_recorder(const trace_recorder&) = delete;
+        trace_recorder& operator=(const trace_recorder&) = delete;
+
+        static trace_recorder& instance()
+        {
+            static trace_recorder recorder;
+            return recorder;
+        }
+
+        void enable()
+        {
+            m_enabled.store(true, std::memory_order_relaxed);
+        }
+
+        void disable()
+        {
+            m_enabled.store(false, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool enabled() const
+        {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        // Names are registered once, spans refer to them by id
+        uint32_t register_name(const std::string& name)
+        {
+            std::lock_guard<std::mutex> lock(m_names_mutex);
+            m_names.push_back(name);
+            return static_cast<uint32_t>(m_names.size() - 1);
+        }
+
+        void record(uint32_t name_id, std::chrono::steady_clock::time_point start, std::chrono::nanoseconds duration)
+        {
+            auto& buffer = m_buffers.local();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            if (buffer.events.size() >= m_max_events_per_thread)
+            {
+                ++buffer.dropped;
+                return;
+            }
+            if (buffer.events.capacity() == 0)
+            {
+                buffer.events.reserve(m_max_events_per_thread);
+            }
+            buffer.events.push_back({name_id, std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_epoch).count(), duration.count()});
+        }
+
+        // Number of spans dropped because a thread's buffer was full, since the last flush
+        [[nodiscard]] uint64_t dropped_events() const
+        {
+            uint64_t dropped = 0;
+            m_buffers.for_each([&dropped](const thread_buffer& buffer) {
+                std::lock_guard<std::mutex> lock(buffer.mutex);
+                dropped += buffer.dropped;
+            });
+            return dropped;
+        }
+
+        // Writes every buffered span as a complete trace and empties the buffers
+        void write_chrome_trace(std::ostream& stream)
+        {
+            std::vector<std::string> names;
+            {
+                std::lock_guard<std::mutex> lock(m_names_mutex);
+                names = m_names;
+            }
+
+            const auto flags = stream.flags();
+            const auto precision = stream.precision(3);
+            stream << std::fixed << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            m_buffers.for_each([&](thread_buffer& buffer) {
+                std::vector<trace_event> events;
+                uint64_t dropped;
+                {
+                    std::lock_guard<std::mutex> lock(buffer.mutex);
+                    events.swap(buffer.events);
+                    dropped = buffer.dropped;
+                    buffer.dropped = 0;
+                }
+
+                stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.thread_index
+                       << ",\"args\":{\"name\":\"thread " << buffer.thread_index << "\"}}";
+                first = false;
+                if (dropped > 0)
+                {
+                    stream << ",\n{\"name\":\"dropped_events\",\"ph\":\"C\",\"pid\":1,\"tid\":" << buffer.thread_index
+                           << ",\"ts\":0,\"args\":{\"dropped\":" << dropped << "}}";
+                }
+                for (const auto& event : events)
+                {
+                    stream << ",\n{\"name\":";
+                    write_json_string(stream, event.name_id < names.size() ? names[event.name_id] : std::string("unknown"));
+                    stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.thread_index
+                           << ",\"ts\":" << static_cast<double>(event.start_ns) / 1000.0
+                           << ",\"dur\":" << static_cast<double>(event.duration_ns) / 1000.0 << "}";
+                }
+            });
+            stream << "\n]}" << std::endl;
+            stream.flags(flags);
+            stream.precision(precision);
+        }
+
+        void write_chrome_trace(const std::filesystem::path& file_path)
+        {
+            std::ofstream file(file_path);
+            if (!file)
+            {
+                throw std::runtime_error("Error: Unable to open trace file " + file_path.string() + " for writing.");
+            }
+            write_chrome_trace(file);
+        }
+
+    private:
+        struct trace_event
+        {
+            uint32_t name_id;
+            int64_t start_ns;
+            int64_t duration_ns;
+        };
+
+        // Created by the thread that owns it on its first span
+        struct thread_buffer
+        {
+            thread_buffer() : thread_index(next_thread_index())
+            {
+            }
+
+            static uint32_t next_thread_index()
+            {
+                static std::atomic<uint32_t> next_index{0};
+                return next_index.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
+
+            uint32_t thread_index;
+            mutable std::mutex mutex;
+            std::vector<trace_event> events;
+            uint64_t dropped = 0;
+        };
+
+        static void write_json_string(std::ostream& stream, const std::string& value)
+        {
+            stream << '"';
+            for (const char c : value)
+            {
+                switch (c)
+                {
+                    case '"': stream << "\\\""; break;
+                    case '\\': stream << "\\\\"; break;
+                    case '\n': stream << "\\n"; break;
+                    case '\r': stream << "\\r"; break;
+                    case '\t': stream << "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20)
+                        {
+                            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+                        }
+                        else
+                        {
+                            stream << c;
+                        }
+                }
+            }
+            stream << '"';
+        }
+
+    private:
+        size_t m_max_events_per_thread;
+        std::atomic<bool> m_enabled;
+        std::chrono::steady_clock::time_point m_epoch;
+        std::mutex m_names_mutex;
+        std::vector<std::string> m_names;
+        detail::thread_shards<thread_buffer> m_buffers;
+    };
+
+    // Records timed scopes as named spans in a trace_recorder. Time scopes with a trace_timer,
+    // which passes the span's begin time along with its duration. Other timers only report a
+    // duration, so for them the span is taken to end when the measurement arrives, which costs
+    // another clock reading and shifts the span by the time between the timer stopping and
+    // the monitor being called.
+    class trace_monitor final : public timer_monitor
+    {
+    public:
+        trace_monitor(trace_recorder& recorder, const std::string& name)
+            : m_recorder(recorder)
+            , m_name_id(recorder.register_name(name))
+        {
+        }
+
+        explicit trace_monitor(const std::string& name) : trace_monitor(trace_recorder::instance(), name)
+        {
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            if (!m_recorder.enabled())
+            {
+                return;
+            }
+            const auto end = std::chrono::steady_clock::now();
+            m_recorder.record(m_name_id, end - duration, duration);
+        }
+
+        void add_span(std::chrono::steady_clock::time_point begin, std::chrono::nanoseconds duration)
+        {
+            if (m_recorder.enabled())
+            {
+                m_recorder.record(m_name_id, begin, duration);
+            }
+        }
+
+        [[nodiscard]] bool enabled() const
+        {
+            return m_recorder.enabled();
+        }
+
+    private:
+        trace_recorder& m_recorder;
+        uint32_t m_name_id;
+    };
+
+#if defined(SAGE_PERFORMANCE_DISABLE)
+    // Timing disabled, the timer holds no state and does nothing
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_trace_timer
+    {
+    public:
+        explicit basic_trace_timer(trace_monitor&) noexcept
+        {
+        }
+
+        basic_trace_timer(const basic_trace_timer&) = delete;
+        basic_trace_timer& operator=(const basic_trace_timer&) = delete;
+    };
+#else
+    // RAII timer that records its scope as a span, with the begin time read when the scope
+    // starts. Spans are placed on the recorder's steady_clock timeline, so with any other
+    // clock the begin time is an extra steady_clock reading while the duration comes from
+    // ClockT. Nothing is read while the recorder is disabled.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_trace_timer
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit basic_trace_timer(trace_monitor& monitor) : m_monitor(monitor), m_recording(monitor.enabled())
+        {
+            if (!m_recording)
+            {
+                return;
+            }
+            if constexpr (std::is_same_v<clock_t, std::chrono::steady_clock>)
+            {
+                m_start_time_point = detail::start_now<clock_t>();
+                m_begin = m_start_time_point;
+            }
+            else
+            {
+                m_begin = std::chrono::steady_clock::now();
+                m_start_time_point = detail::start_now<clock_t>();
+            }
+        }
+
+        ~basic_trace_timer()
+        {
+            if (m_recording)
+            {
+                const auto end_time_point = detail::stop_now<clock_t>();
+                m_monitor.add_span(m_begin, std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_point - m_start_time_point));
+            }
+        }
+
+        basic_trace_timer(const basic_trace_timer&) = delete;
+        basic_trace_timer& operator=(const basic_trace_timer&) = delete;
+
+    private:
+        trace_monitor& m_monitor;
+        bool m_recording;
+        std::chrono::steady_clock::time_point m_begin;
+        time_point_t m_start_time_point;
+    };
+#endif
+
+    using trace_timer = basic_trace_timer<>;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SAGE_PERFORMANCE_HAS_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#else
+#define SAGE_PERFORMANCE_HAS_TSC 0
+#endif
+
+namespace sage::performance
+{
+    // Clock that reads the CPU time stamp counter, which is far cheaper than going through the
+    // OS clock. Ticks are converted to nanoseconds with a factor calibrated against
+    // steady_clock the first time the clock is used, call calibrate() at startup to take that
+    // cost (around 20ms) up front. The TSC is only used if the CPU reports it as invariant,
+    // i.e. it ticks at a constant rate across cores and power states, otherwise, and on non
+    // x86-64 targets, the clock falls back to reading steady_clock.
+    // start_now() and stop_now() fence the counter read so that the timed code can not be
+    // reordered out of the measured region, basic_timer uses them when they are available.
+    class tsc_clock
+    {
+    public:
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::nanoseconds;
+        using time_point = std::chrono::time_point<tsc_clock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept
+        {
+            const auto& data = calibration();
+            if (!data.use_tsc)
+            {
+                return fallback_now();
+            }
+#if SAGE_PERFORMANCE_HAS_TSC
+            _mm_lfence();
+            const uint64_t ticks = __rdtsc();
+            _mm_lfence();
+            return to_time_point(data, ticks);
+#else
+            return fallback_now();
+#endif
+        }
+
+        // Waits for preceding instructions to finish, and stops later ones starting, before reading
+        static time_point start_now() noexcept
+        {
+            return now();
+        }
+
+        // Waits for the timed instructions to finish before reading
+        static time_point stop_now() noexcept
+        {
+            const auto& data = calibration();
+            if (!data.use_tsc)
+            {
+                return fallback_now();
+            }
+#if SAGE_PERFORMANCE_HAS_TSC
+            unsigned int aux;
+            const uint64_t ticks = __rdtscp(&aux);
+            _mm_lfence();
+            return to_time_point(data, ticks);
+#else
+            return fallback_now();
+#endif
+        }
+
+        // True if the time stamp counter is being read, false if falling back to steady_clock
+        static bool is_using_tsc() noexcept
+        {
+            return calibration().use_tsc;
+        }
+
+        // Calibrated counter frequency, 0 when falling back to steady_clock
+        static double ticks_per_second() noexcept
+        {
+            return calibration().ticks_per_second;
+        }
+
+        static void calibrate() noexcept
+        {
+            calibration();
+        }
+
+    private:
+        struct calibration_data
+        {
+            bool use_tsc = false;
+            double ticks_per_second = 0.0;
+            uint64_t base_ticks = 0;
+            // Nanoseconds are ((ticks - base_ticks) * multiplier) >> shift
+            uint64_t multiplier = 0;
+        };
+
+        static constexpr int shift = 32;
+
+        static const calibration_data& calibration() noexcept
+        {
+            static const calibration_data data = run_calibration();
+            return data;
+        }
+
+        static time_point fallback_now() noexcept
+        {
+            return time_point(std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch()));
+        }
+
+#if SAGE_PERFORMANCE_HAS_TSC
+        static bool has_invariant_tsc() noexcept
+        {
+            // CPUID.80000007H:EDX[8] advertises the invariant TSC
+#if defined(_MSC_VER)
+            int registers[4];
+            __cpuid(registers, 0x80000000);
+            if (static_cast<unsigned int>(registers[0]) < 0x80000007u)
+            {
+                return false;
+            }
+            __cpuid(registers, 0x80000007);
+            return (registers[3] & (1 << 8)) != 0;
+#else
+            unsigned int eax, ebx, ecx, edx;
+            if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007u)
+            {
+                return false;
+            }
+            __cpuid(0x80000007, eax, ebx, ecx, edx);
+            return (edx & (1u << 8)) != 0;
+#endif
+        }
+
+        static uint64_t multiply_shift(uint64_t ticks, uint64_t multiplier) noexcept
+        {
+#if defined(_MSC_VER)
+            uint64_t high;
+            const uint64_t low = _umul128(ticks, multiplier, &high);
+            return __shiftright128(low, high, shift);
+#else
+            // __extension__ keeps -Wpedantic quiet about the non standard 128 bit type
+            __extension__ typedef unsigned __int128 uint128_t;
+            return static_cast<uint64_t>((static_cast<uint128_t>(ticks) * multiplier) >> shift);
+#endif
+        }
+
+        static time_point to_time_point(const calibration_data& data, uint64_t ticks) noexcept
+        {
+            return time_point(duration(static_cast<rep>(multiply_shift(ticks - data.base_ticks, data.multiplier))));
+        }
+#endif
+
+        static calibration_data run_calibration() noexcept
+        {
+            calibration_data data;
+#if SAGE_PERFORMANCE_HAS_TSC
+            if (!has_invariant_tsc())
+            {
+                return data;
+            }
+            const auto calibration_period = std::chrono::milliseconds(20);
+            _mm_lfence();
+            const auto start_ticks = __rdtsc();
+            const auto start_time = std::chrono::steady_clock::now();
+            auto end_time = start_time;
+            while (end_time - start_time < calibration_period)
+            {
+                end_time = std::chrono::steady_clock::now();
+            }
+            _mm_lfence();
+            const auto end_ticks = __rdtsc();
+
+            const double elapsed_ns = std::chrono::duration<double, std::nano>(end_time - start_time).count();
+            const auto elapsed_ticks = static_cast<double>(end_ticks - start_ticks);
+            if (elapsed_ticks <= 0.0)
+            {
+                return data;
+            }
+            data.use_tsc = true;
+            data.ticks_per_second = elapsed_ticks * 1e9 / elapsed_ns;
+            data.base_ticks = start_ticks;
+            data.multiplier = static_cast<uint64_t>(elapsed_ns / elapsed_ticks * static_cast<double>(uint64_t(1) << shift) + 0.5);
+#endif
+            return data;
+        }
+    };
+
+    using tsc_timer = basic_timer<tsc_clock>;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "histogram_monitor.hpp"
+#include "timer_monitor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace sage::performance
+{
+    // Keeps measurements from the recent past only, for live views such as the request rate
+    // and latency percentiles over the last 10 seconds or 5 minutes of a running service.
+    // Time is split into buckets of bucket_width, each holding a histogram of the measurements
+    // that arrived during it, in a ring of bucket_count buckets. A bucket is reset when it is
+    // reused for a newer slice of time, so old data expires as new measurements arrive without
+    // a background thread, and memory is fixed at bucket_count histograms.
+    // Windows are rounded up to whole buckets, the newest of which is partly filled. Thread
+    // safe, measurements and queries take a lock.
+    template <typename ClockT = std::chrono::steady_clock>
+    class basic_window_monitor final : public timer_monitor
+    {
+    public:
+        using clock_t = ClockT;
+        using time_point_t = typename clock_t::time_point;
+
+        explicit basic_window_monitor(std::chrono::nanoseconds bucket_width = std::chrono::seconds(1),
+                                      size_t bucket_count = 60,
+                                      std::chrono::nanoseconds lowest_discernible = std::chrono::microseconds(1),
+                                      std::chrono::nanoseconds highest_trackable = std::chrono::minutes(1),
+                                      int significant_digits = 2)
+            : m_bucket_width(bucket_width)
+            , m_lowest_discernible(lowest_discernible)
+            , m_highest_trackable(highest_trackable)
+            , m_significant_digits(significant_digits)
+            , m_origin(clock_t::now())
+        {
+            if (m_bucket_width.count() <= 0 || bucket_count == 0)
+            {
+                throw std::invalid_argument("Error: Window monitor needs a positive bucket width and at least one bucket.");
+            }
+            m_buckets.reserve(bucket_count);
+            for (size_t i = 0; i < bucket_count; ++i)
+            {
+                m_buckets.push_back({no_epoch, histogram_monitor(lowest_discernible, highest_trackable, significant_digits)});
+            }
+        }
+
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            const int64_t epoch = epoch_at(clock_t::now());
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& slot = m_buckets[static_cast<size_t>(epoch) % m_buckets.size()];
+            if (slot.epoch != epoch)
+            {
+                slot.histogram.reset();
+                slot.epoch = epoch;
+            }
+            slot.histogram.add_measurement(duration);
+        }
+
+        // Longest window that can be queried
+        [[nodiscard]] std::chrono::nanoseconds max_window() const
+        {
+            return m_bucket_width * static_cast<int64_t>(m_buckets.size());
+        }
+
+        // Merged histogram of the measurements in the window ending now
+        [[nodiscard]] histogram_monitor snapshot(std::chrono::nanoseconds window) const
+        {
+            const int64_t newest = epoch_at(clock_t::now());
+            const int64_t oldest = newest - buckets_in(window) + 1;
+            histogram_monitor merged(m_lowest_discernible, m_highest_trackable, m_significant_digits);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& slot : m_buckets)
+            {
+                if (slot.epoch >= oldest && slot.epoch <= newest)
+                {
+                    merged.merge(slot.histogram);
+                }
+            }
+            return merged;
+        }
+
+        [[nodiscard]] uint64_t count(std::chrono::nanoseconds window) const
+        {
+            return snapshot(window).count();
+        }
+
+        // Measurements per second over the window ending now. Before the window has been
+        // running for its full length the rate is over the time since construction.
+        [[nodiscard]] double rate(std::chrono::nanoseconds window) const
+        {
+            const auto now = clock_t::now();
+            const int64_t newest = epoch_at(now);
+            const auto since_origin = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_origin);
+            const auto into_newest = since_origin - m_bucket_width * newest;
+            const auto covered = std::min(m_bucket_width * (buckets_in(window) - 1) + into_newest, since_origin);
+            if (covered.count() <= 0)
+            {
+                return 0.0;
+            }
+            return static_cast<double>(count(window)) / std::chrono::duration<double>(covered).count();
+        }
+
+        // In milliseconds, NaN if there were no measurements in the window
+        [[nodiscard]] double value_at_percentile(std::chrono::nanoseconds window, double percentile) const
+        {
+            return snapshot(window).value_at_percentile(percentile);
+        }
+
+    private:
+        static constexpr int64_t no_epoch = -1;
+
+        struct bucket
+        {
+            // Index of the slice of time the histogram holds, counted in bucket widths since
+            // construction
+            int64_t epoch;
+            histogram_monitor histogram;
+        };
+
+        [[nodiscard]] int64_t epoch_at(time_point_t time_point) const
+        {
+            return std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time_point - m_origin) / m_bucket_width, 0);
+        }
+
+        [[nodiscard]] int64_t buckets_in(std::chrono::nanoseconds window) const
+        {
+            if (window.count() <= 0 || window > max_window())
+            {
+                throw std::invalid_argument("Error: Window must be positive and no longer than the window monitor keeps.");
+            }
+            return (window + m_bucket_width - std::chrono::nanoseconds(1)) / m_bucket_width;
+        }
+
+    private:
+        std::chrono::nanoseconds m_bucket_width;
+        std::chrono::nanoseconds m_lowest_discernible;
+        std::chrono::nanoseconds m_highest_trackable;
+        int m_significant_digits;
+        time_point_t m_origin;
+        mutable std::mutex m_mutex;
+        std::vector<bucket> m_buckets;
+    };
+
+    using window_monitor = basic_window_monitor<>;
+}
@@ -0,0 +1,96 @@
+// Built into its own executable with SAGE_PERFORMANCE_DISABLE defined for every source
+#include <sage/performance/monitors.hpp>
+#include <sage/performance/benchmark.hpp>
+#include <sage/performance/profiler.hpp>
+#include <sage/performance/sampling_monitor.hpp>
+#include <sage/performance/counter_timer.hpp>
+#include <sage/performance/cpu_timer.hpp>
+#include <sage/performance/lap_timer.hpp>
+#include <sage/performance/coroutine_timer.hpp>
+#include <sage/performance/throughput_timer.hpp>
+#include <sage/performance/memory_timer.hpp>
+#include <sage/performance/trace_monitor.hpp>
+
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(DisabledTimerTests, TestDisabledTimerHasNoState)
+{
+    ASSERT_FALSE(sage::performance::timers_enabled);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::timer>);
+    ASSERT_TRUE(std::is_trivially_destructible_v<sage::performance::timer>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::profile_zone>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::sampling_timer<sage::performance::reservoir_monitor>>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::counter_timer>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::cpu_timer>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::lap_timer>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::throughput_timer>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::memory_timer>);
+    ASSERT_TRUE(std::is_empty_v<sage::performance::trace_timer>);
+}
+
+TEST(DisabledTimerTests, TestDisabledTimerReportsNothing)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        sage::performance::timer t(perf_monitor);
+        SAGE_PROFILE_ZONE("disabled_zone");
+    }
+
+    ASSERT_TRUE(perf_monitor.get_measurements().empty());
+    ASSERT_TRUE(sage::performance::profiler::instance().report().children.empty());
+}
+
+TEST(DisabledTimerTests, TestDisabledMeasureStillCallsAndReturns)
+{
+    sage::performance::performance_monitor perf_monitor;
+    const auto result = sage::performance::measure(perf_monitor, [](int a) { return a * 2; }, 21);
+
+    ASSERT_EQ(result, 42);
+    ASSERT_TRUE(perf_monitor.get_measurements().empty());
+}
+
+TEST(DisabledTimerTests, TestDisabledSamplingTimerCountsNothing)
+{
+    sage::performance::reservoir_monitor reservoir(8);
+    {
+        sage::performance::sampling_timer t(reservoir);
+    }
+
+    ASSERT_EQ(reservoir.calls(), 0);
+}
+
+TEST(DisabledTimerTests, TestDisabledTimerCanBePausedAndMoved)
+{
+    ASSERT_TRUE(std::is_nothrow_move_constructible_v<sage::performance::timer>);
+
+    sage::performance::performance_monitor perf_monitor;
+    {
+        sage::performance::timer t(perf_monitor);
+        t.pause();
+        t.resume();
+        sage::performance::timer moved(std::move(t));
+        moved.cancel();
+    }
+
+    ASSERT_TRUE(perf_monitor.get_measurements().empty());
+}
+
+TEST(DisabledTimerTests, TestBenchmarksStillTimeWithTimersDisabled)
+{
+    sage::performance::benchmark_options options;
+    options.target_time = std::chrono::milliseconds(2);
+    options.warmup_time = std::chrono::milliseconds(1);
+    options.repetitions = 3;
+    const auto result = sage::performance::run_benchmark("sleep", []() {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }, options);
+
+    ASSERT_LT(result.iterations, 1000u);
+    ASSERT_GE(result.median(), 100000.0);
+    ASSERT_GT(sage::performance::calibrated_timer_overhead().samples, 0u);
+}
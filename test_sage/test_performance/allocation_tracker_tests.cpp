@@ -0,0 +1,136 @@
+// Installs the counting operator new and delete for the whole test executable
+#define SAGE_ALLOCATION_TRACKING_IMPLEMENTATION
+#include <sage/performance/allocation_tracker.hpp>
+#include <sage/performance/allocation_testing.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gtest/gtest-spi.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    class recording_allocation_monitor final : public sage::performance::allocation_monitor
+    {
+    public:
+        // Reserved so that recording does not allocate inside an enclosing scope
+        recording_allocation_monitor()
+        {
+            measurements.reserve(8);
+        }
+
+        void add_measurement(const sage::performance::allocation_stats& stats) override
+        {
+            measurements.push_back(stats);
+        }
+
+        std::vector<sage::performance::allocation_stats> measurements;
+    };
+
+    struct alignas(64) over_aligned
+    {
+        char data[64];
+    };
+}
+
+TEST(AllocationTrackerTests, TestAllocationTrackingIsInstalled)
+{
+    ASSERT_TRUE(sage::performance::allocation_tracking_installed());
+}
+
+TEST(AllocationTrackerTests, TestAllocationScopeCountsAllocations)
+{
+    recording_allocation_monitor monitor;
+    {
+        sage::performance::allocation_scope scope(monitor);
+        auto first = std::make_unique<char[]>(100);
+        auto second = std::make_unique<char[]>(300);
+        first.reset();
+    }
+
+    ASSERT_EQ(monitor.measurements.size(), 1);
+    const auto& stats = monitor.measurements.front();
+    ASSERT_EQ(stats.allocations, 2);
+    ASSERT_EQ(stats.deallocations, 2);
+    ASSERT_EQ(stats.bytes_allocated, 400);
+    ASSERT_EQ(stats.bytes_freed, 400);
+    ASSERT_EQ(stats.peak_live_bytes, 400);
+}
+
+TEST(AllocationTrackerTests, TestNestedScopesReportTheirOwnPeak)
+{
+    recording_allocation_monitor monitor;
+    {
+        sage::performance::allocation_scope outer(monitor);
+        {
+            auto big = std::make_unique<char[]>(1000);
+        }
+        auto kept = std::make_unique<char[]>(10);
+        {
+            sage::performance::allocation_scope inner(monitor);
+            auto small = std::make_unique<char[]>(50);
+        }
+    }
+
+    ASSERT_EQ(monitor.measurements.size(), 2);
+    const auto& inner = monitor.measurements[0];
+    const auto& outer = monitor.measurements[1];
+    ASSERT_EQ(inner.allocations, 1);
+    ASSERT_EQ(inner.peak_live_bytes, 50);
+    ASSERT_EQ(outer.allocations, 3);
+    ASSERT_EQ(outer.peak_live_bytes, 1000);
+}
+
+TEST(AllocationTrackerTests, TestAlignedAllocationsAreCounted)
+{
+    recording_allocation_monitor monitor;
+    {
+        sage::performance::allocation_scope scope(monitor);
+        auto aligned = std::make_unique<over_aligned>();
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned.get()) % 64, 0);
+    }
+
+    ASSERT_EQ(monitor.measurements.front().allocations, 1);
+    ASSERT_EQ(monitor.measurements.front().bytes_allocated, sizeof(over_aligned));
+    ASSERT_EQ(monitor.measurements.front().bytes_freed, sizeof(over_aligned));
+}
+
+TEST(AllocationTrackerTests, TestCountersArePerThread)
+{
+    recording_allocation_monitor monitor;
+    {
+        sage::performance::allocation_scope scope(monitor);
+        std::thread([]() {
+            std::vector<int> values(1000);
+        }).join();
+    }
+
+    // Only the thread's own bookkeeping, not the vector allocated on the other thread
+    ASSERT_THAT(monitor.measurements.front().bytes_allocated, ::testing::Lt(1000 * sizeof(int)));
+}
+
+TEST(AllocationTrackerTests, TestAllocationSummaryMonitorTotals)
+{
+    sage::performance::allocation_summary_monitor monitor;
+    monitor.add_measurement({2, 1, 100, 50, 80});
+    monitor.add_measurement({4, 4, 300, 300, 200});
+
+    ASSERT_EQ(monitor.count(), 2);
+    ASSERT_EQ(monitor.totals().allocations, 6);
+    ASSERT_EQ(monitor.totals().bytes_allocated, 400);
+    ASSERT_EQ(monitor.totals().peak_live_bytes, 200);
+    ASSERT_DOUBLE_EQ(monitor.average_allocations(), 3.0);
+}
+
+TEST(AllocationTrackerTests, TestExpectNoAllocations)
+{
+    std::vector<int> values;
+    values.reserve(16);
+    SAGE_EXPECT_NO_ALLOCATIONS(values.push_back(1));
+    SAGE_ASSERT_NO_ALLOCATIONS(values.assign({1, 2, 3}));
+    EXPECT_NONFATAL_FAILURE(SAGE_EXPECT_NO_ALLOCATIONS(std::string(100, 'x')), "Expected no allocations");
+}
@@ -0,0 +1,177 @@
+#include <sage/performance/async_monitor.hpp>
+#include <sage/performance/monitors.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    // Holds up the background thread until released, so tests can fill the buffer
+    class gated_monitor final : public sage::performance::timer_monitor
+    {
+    public:
+        void add_measurement(std::chrono::nanoseconds duration) override
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_released.wait(lock, [this]() { return m_open; });
+            measurements.push_back(duration);
+        }
+
+        void open()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_open = true;
+            }
+            m_released.notify_all();
+        }
+
+        std::vector<std::chrono::nanoseconds> measurements;
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_released;
+        bool m_open = false;
+    };
+}
+
+TEST(AsyncMonitorTests, TestAsyncMonitorForwardsMeasurementsInOrder)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::async_monitor async(perf_monitor);
+    async.add_measurement(std::chrono::milliseconds(100));
+    async.add_measurement(std::chrono::milliseconds(200));
+    async.add_measurement(std::chrono::milliseconds(300));
+    async.flush();
+
+    ASSERT_THAT(perf_monitor.get_measurements(), ::testing::ContainerEq(std::vector<double>({100, 200, 300})));
+}
+
+TEST(AsyncMonitorTests, TestAsyncMonitorStopDrainsBuffer)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::async_monitor async(perf_monitor, 1024, sage::performance::overflow_policy::block, std::chrono::milliseconds(50));
+    for (int i = 0; i < 1000; ++i)
+    {
+        async.add_measurement(std::chrono::milliseconds(1));
+    }
+    async.stop();
+
+    ASSERT_EQ(perf_monitor.get_measurements().size(), 1000u);
+    ASSERT_EQ(async.dropped(), 0u);
+
+    async.add_measurement(std::chrono::milliseconds(1));
+    ASSERT_EQ(async.dropped(), 1u);
+}
+
+TEST(AsyncMonitorTests, TestAsyncMonitorForwardsFromManyThreads)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        sage::performance::async_monitor async(perf_monitor, 64, sage::performance::overflow_policy::block);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&async]() {
+                for (int i = 0; i < 5000; ++i)
+                {
+                    sage::performance::timer timer(async);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    ASSERT_EQ(perf_monitor.get_measurements().size(), 20000u);
+}
+
+TEST(AsyncMonitorTests, TestAsyncMonitorCountsDroppedMeasurementsWhenFull)
+{
+    gated_monitor gated;
+    sage::performance::async_monitor async(gated, 4, sage::performance::overflow_policy::count_dropped);
+    for (int i = 0; i < 20; ++i)
+    {
+        async.add_measurement(std::chrono::milliseconds(1));
+    }
+    // At most one measurement can have been taken by the background thread
+    ASSERT_GE(async.dropped(), 20u - 4u - 1u);
+
+    gated.open();
+    async.stop();
+    ASSERT_EQ(gated.measurements.size() + async.dropped(), 20u);
+}
+
+TEST(AsyncMonitorTests, TestAsyncMonitorDropPolicyDoesNotCount)
+{
+    gated_monitor gated;
+    sage::performance::async_monitor async(gated, 4, sage::performance::overflow_policy::drop);
+    for (int i = 0; i < 20; ++i)
+    {
+        async.add_measurement(std::chrono::milliseconds(1));
+    }
+
+    ASSERT_EQ(async.dropped(), 0u);
+    gated.open();
+    async.stop();
+    ASSERT_LE(gated.measurements.size(), 5u);
+}
+
+TEST(AsyncMonitorTests, TestAsyncMonitorStopWhileProducingLosesNothing)
+{
+    constexpr size_t per_thread = 20000;
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::async_monitor async(perf_monitor, 64, sage::performance::overflow_policy::count_dropped);
+    std::atomic<bool> started{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&async, &started]() {
+            for (size_t i = 0; i < per_thread; ++i)
+            {
+                async.add_measurement(std::chrono::microseconds(1));
+                started.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+    while (!started.load(std::memory_order_relaxed))
+    {
+        std::this_thread::yield();
+    }
+    async.stop();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Every measurement was either forwarded or counted as dropped, including those racing stop()
+    ASSERT_EQ(perf_monitor.get_measurements().size() + async.dropped(), 4 * per_thread);
+}
+
+TEST(AsyncMonitorTests, TestBoundedQueueIsFifoAndBounded)
+{
+    sage::performance::detail::bounded_queue<int> queue(3);
+    ASSERT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(queue.try_push(i));
+    }
+    ASSERT_FALSE(queue.try_push(4));
+
+    int value;
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_FALSE(queue.try_pop(value));
+    ASSERT_EQ(queue.pushed(), 4u);
+}
@@ -0,0 +1,101 @@
+#include <sage/performance/benchmark.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    sage::performance::benchmark_options quick_options()
+    {
+        sage::performance::benchmark_options options;
+        options.target_time = std::chrono::milliseconds(2);
+        options.warmup_time = std::chrono::milliseconds(1);
+        options.repetitions = 5;
+        return options;
+    }
+}
+
+TEST(BenchmarkTests, TestRunBenchmarkChoosesIterationsAndReportsStatistics)
+{
+    int counter = 0;
+    const auto result = sage::performance::run_benchmark("increment", [&counter]() {
+        ++counter;
+        sage::performance::do_not_optimize(counter);
+    }, quick_options());
+
+    ASSERT_EQ(result.name, "increment");
+    ASSERT_GT(result.iterations, 1u);
+    ASSERT_EQ(result.samples.size(), 5u);
+    ASSERT_GT(result.mean(), 0.0);
+    ASSERT_LE(result.min(), result.median());
+    ASSERT_GE(result.stddev(), 0.0);
+}
+
+TEST(BenchmarkTests, TestRunBenchmarkRespectsMaxIterations)
+{
+    auto options = quick_options();
+    options.max_iterations = 7;
+    size_t calls = 0;
+    const auto result = sage::performance::run_benchmark("capped", [&calls]() { ++calls; }, options);
+
+    ASSERT_EQ(result.iterations, 7u);
+}
+
+TEST(BenchmarkTests, TestRunBenchmarkSlowBodyRunsOnceAndMeasuresIt)
+{
+    auto options = quick_options();
+    options.repetitions = 2;
+    const auto result = sage::performance::run_benchmark("sleep", []() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }, options);
+
+    ASSERT_GE(result.iterations, 1u);
+    ASSERT_LE(result.iterations, 2u);
+    ASSERT_GE(result.min(), 1e6);
+}
+
+TEST(BenchmarkTests, TestBenchmarkCsvOutput)
+{
+    sage::performance::benchmark_result result{"bench", 100, {1.5, 2.5}};
+    std::stringstream ss;
+    sage::performance::write_benchmark_csv(ss, {result});
+
+    ASSERT_EQ(ss.str(), "name,repetition,iterations,ns_per_iteration\nbench,0,100,1.5\nbench,1,100,2.5\n");
+    ASSERT_EQ(ss.precision(), 6);
+}
+
+TEST(BenchmarkTests, TestRunBenchmarksRejectsInvalidOptions)
+{
+    const auto run = [](std::vector<std::string> args) {
+        args.insert(args.begin(), "bench");
+        std::vector<char*> argv;
+        for (auto& arg : args)
+        {
+            argv.push_back(arg.data());
+        }
+        return sage::performance::run_benchmarks(static_cast<int>(argv.size()), argv.data());
+    };
+
+    ASSERT_EQ(run({"-r", "abc"}), 1);
+    ASSERT_EQ(run({"-r", "0"}), 1);
+    ASSERT_EQ(run({"-t", "5ms"}), 1);
+    ASSERT_EQ(run({"-f", "("}), 1);
+    ASSERT_EQ(run({"-s", "-j", "x"}), 1);
+}
+
+TEST(StatisticsTests, TestSummaryStatistics)
+{
+    const std::vector<double> samples = {4, 1, 3, 2};
+
+    ASSERT_THAT(sage::performance::statistics::mean(samples), testing::DoubleEq(2.5));
+    ASSERT_THAT(sage::performance::statistics::median(samples), testing::DoubleEq(2.5));
+    ASSERT_THAT(sage::performance::statistics::median({5, 1, 3}), testing::DoubleEq(3));
+    ASSERT_THAT(sage::performance::statistics::stddev(samples), testing::DoubleEq(std::sqrt(5.0 / 3.0)));
+    ASSERT_THAT(sage::performance::statistics::min(samples), testing::DoubleEq(1));
+    ASSERT_THAT(sage::performance::statistics::max(samples), testing::DoubleEq(4));
+    ASSERT_TRUE(std::isnan(sage::performance::statistics::mean({})));
+}
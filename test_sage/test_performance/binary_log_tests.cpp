@@ -0,0 +1,156 @@
+#include <sage/performance/binary_log.hpp>
+#include <sage/performance/timer.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    std::filesystem::path temporary_log_path(const std::string& name)
+    {
+        return std::filesystem::temp_directory_path() / ("sage_binary_log_" + name + ".bin");
+    }
+}
+
+TEST(BinaryLogTests, TestBinaryLogRoundTrip)
+{
+    const auto path = temporary_log_path("round_trip");
+    {
+        sage::performance::binary_log_writer writer(path);
+        sage::performance::binary_log_monitor parse(writer, "parse");
+        sage::performance::binary_log_monitor render(writer, "render");
+        parse.add_measurement(std::chrono::nanoseconds(5));
+        render.add_measurement(std::chrono::milliseconds(250));
+        parse.add_measurement(std::chrono::hours(2));
+        parse.add_measurement(std::chrono::nanoseconds(-3));
+    }
+
+    sage::performance::binary_log_reader reader(path);
+    std::vector<sage::performance::binary_log_record> records(reader.begin(), reader.end());
+    ASSERT_EQ(records.size(), 4);
+    ASSERT_EQ(records[0].monitor_name, "parse");
+    ASSERT_EQ(records[0].duration, std::chrono::nanoseconds(5));
+    ASSERT_EQ(records[1].monitor_id, 1);
+    ASSERT_EQ(records[1].monitor_name, "render");
+    ASSERT_EQ(records[1].duration, std::chrono::milliseconds(250));
+    ASSERT_EQ(records[2].duration, std::chrono::hours(2));
+    ASSERT_EQ(records[3].duration, std::chrono::nanoseconds(-3));
+    for (size_t i = 1; i < records.size(); ++i)
+    {
+        ASSERT_GE(records[i].timestamp, records[i - 1].timestamp);
+    }
+    const auto since_start = std::chrono::system_clock::now() - reader.start_time();
+    ASSERT_THAT(since_start, ::testing::AllOf(::testing::Ge(std::chrono::seconds(0)), ::testing::Lt(std::chrono::minutes(1))));
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLogTests, TestBinaryLogIsCompact)
+{
+    const auto path = temporary_log_path("compact");
+    {
+        sage::performance::binary_log_writer writer(path);
+        sage::performance::binary_log_monitor monitor(writer, "m");
+        for (int i = 0; i < 10000; ++i)
+        {
+            sage::performance::timer t(monitor);
+        }
+    }
+
+    sage::performance::binary_log_reader reader(path);
+    ASSERT_EQ(std::distance(reader.begin(), reader.end()), 10000);
+    // Tag, id, small timestamp delta and duration, a few bytes each rather than 8 byte doubles
+    ASSERT_LT(reader.size(), 10000 * 8);
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLogTests, TestBinaryLogFromManyThreads)
+{
+    const auto path = temporary_log_path("threads");
+    {
+        sage::performance::binary_log_writer writer(path, 256);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&writer, t]() {
+                sage::performance::binary_log_monitor monitor(writer, "thread_" + std::to_string(t));
+                for (int i = 0; i < 1000; ++i)
+                {
+                    monitor.add_measurement(std::chrono::microseconds(t));
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    sage::performance::binary_log_reader reader(path);
+    std::map<std::string, int> counts;
+    for (const auto& record : reader)
+    {
+        ASSERT_EQ("thread_" + std::to_string(record.duration.count() / 1000), record.monitor_name);
+        ++counts[std::string(record.monitor_name)];
+    }
+    ASSERT_EQ(counts.size(), 4);
+    ASSERT_THAT(counts, ::testing::Each(::testing::Pair(::testing::_, 1000)));
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLogTests, TestBinaryLogIgnoresTruncatedRecord)
+{
+    const auto path = temporary_log_path("truncated");
+    {
+        sage::performance::binary_log_writer writer(path);
+        sage::performance::binary_log_monitor monitor(writer, "m");
+        monitor.add_measurement(std::chrono::seconds(1));
+        monitor.add_measurement(std::chrono::seconds(2));
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+    sage::performance::binary_log_reader reader(path);
+    std::vector<sage::performance::binary_log_record> records(reader.begin(), reader.end());
+    ASSERT_EQ(records.size(), 1);
+    ASSERT_EQ(records[0].duration, std::chrono::seconds(1));
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLogTests, TestBinaryLogStopsAtOutOfOrderName)
+{
+    const auto path = temporary_log_path("bad_name_id");
+    {
+        sage::performance::binary_log_writer writer(path);
+        sage::performance::binary_log_monitor monitor(writer, "m");
+        monitor.add_measurement(std::chrono::seconds(1));
+    }
+    {
+        // Name record for id 2^62 followed by a measurement against it
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        const unsigned char record[] = {0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x40, 0x01, 'x',
+                                        0x02, 0x00, 0x00, 0x02};
+        file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+
+    sage::performance::binary_log_reader reader(path);
+    std::vector<sage::performance::binary_log_record> records(reader.begin(), reader.end());
+    ASSERT_EQ(records.size(), 1);
+    ASSERT_EQ(records[0].monitor_name, "m");
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLogTests, TestBinaryLogReaderRejectsOtherFiles)
+{
+    const auto path = temporary_log_path("not_a_log");
+    {
+        std::ofstream file(path);
+        file << "this is a text file, not a binary log";
+    }
+    ASSERT_THROW(sage::performance::binary_log_reader reader(path), std::runtime_error);
+    std::filesystem::remove(path);
+    ASSERT_THROW(sage::performance::binary_log_reader reader(path), std::runtime_error);
+}
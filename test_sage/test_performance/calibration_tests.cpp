@@ -0,0 +1,80 @@
+#include <sage/performance/calibration.hpp>
+#include <sage/performance/benchmark.hpp>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "test_clocks.hpp"
+
+namespace
+{
+    using stepping_clock = sage_test::stepping_clock<5>;
+}
+
+TEST(CalibrationTests, TestCalibrationMeasuresEmptyScope)
+{
+    const auto overhead = sage::performance::calibrate_timer_overhead<stepping_clock>(1000);
+
+    ASSERT_EQ(overhead.samples, 1000u);
+    ASSERT_DOUBLE_EQ(overhead.median, 5.0);
+    ASSERT_DOUBLE_EQ(overhead.stddev, 0.0);
+    ASSERT_DOUBLE_EQ(overhead.min, 5.0);
+    // Two clock readings per scope, plus one step for the readings around the loop
+    ASSERT_DOUBLE_EQ(overhead.cost, 10.005);
+}
+
+TEST(CalibrationTests, TestCalibrationOfSteadyClock)
+{
+    const auto overhead = sage::performance::calibrate_timer_overhead(2000);
+
+    ASSERT_EQ(overhead.samples, 2000u);
+    ASSERT_GE(overhead.min, 0.0);
+    ASSERT_LE(overhead.min, overhead.median);
+    ASSERT_GE(overhead.cost, overhead.min);
+    // Reading a clock takes nowhere near a millisecond
+    ASSERT_LT(overhead.median, 1e6);
+}
+
+TEST(CalibrationTests, TestCalibratedOverheadIsOnlyMeasuredOnce)
+{
+    const auto& first = sage::performance::calibrated_timer_overhead();
+    const auto& second = sage::performance::calibrated_timer_overhead();
+
+    ASSERT_EQ(&first, &second);
+    ASSERT_GT(first.samples, 0u);
+}
+
+TEST(CalibrationTests, TestOverheadSummaryString)
+{
+    sage::performance::timer_overhead overhead{18.0, 2.1, 15.0, 31.0, 100};
+
+    ASSERT_EQ(overhead.s_summary(), "timer overhead 18.00ns (stddev 2.10ns, min 15.00ns), 31.00ns per timed scope");
+}
+
+TEST(CalibrationTests, TestCorrectedMonitorSubtractsOverheadAndClampsAtZero)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::timer_overhead overhead;
+    overhead.median = 20.4;
+    sage::performance::overhead_corrected_monitor corrected(perf_monitor, overhead);
+    corrected.add_measurement(std::chrono::nanoseconds(1020));
+    corrected.add_measurement(std::chrono::nanoseconds(10));
+
+    ASSERT_EQ(corrected.overhead(), std::chrono::nanoseconds(20));
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(0.001), testing::DoubleEq(0.0)));
+}
+
+TEST(CalibrationTests, TestBenchmarkSubtractsOverheadUnlessDisabled)
+{
+    sage::performance::benchmark_options options;
+    options.target_time = std::chrono::milliseconds(1);
+    options.warmup_time = std::chrono::milliseconds(1);
+    options.repetitions = 2;
+    const auto corrected = sage::performance::run_benchmark("corrected", []() {}, options);
+    options.subtract_timer_overhead = false;
+    const auto uncorrected = sage::performance::run_benchmark("uncorrected", []() {}, options);
+
+    ASSERT_DOUBLE_EQ(corrected.timer_overhead, sage::performance::calibrated_timer_overhead().median);
+    ASSERT_GE(corrected.min(), 0.0);
+    ASSERT_DOUBLE_EQ(uncorrected.timer_overhead, 0.0);
+}
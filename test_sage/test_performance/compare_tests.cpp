@@ -0,0 +1,178 @@
+#include <sage/performance/compare.hpp>
+#include <sage/performance/benchmark.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    std::vector<double> noisy_samples(double centre, size_t count, uint64_t seed)
+    {
+        std::mt19937_64 generator(seed);
+        std::lognormal_distribution<double> noise(0.0, 0.05);
+        std::vector<double> samples;
+        for (size_t i = 0; i < count; ++i)
+        {
+            samples.push_back(centre * noise(generator));
+        }
+        return samples;
+    }
+}
+
+TEST(CompareTests, TestMannWhitneyUSeparatedSets)
+{
+    const auto result = sage::performance::statistics::mann_whitney_u({1, 2, 3, 4, 5}, {6, 7, 8, 9, 10});
+
+    ASSERT_DOUBLE_EQ(result.u, 0.0);
+    ASSERT_NEAR(result.z, -2.5067, 1e-4);
+    ASSERT_NEAR(result.p_value, 0.01219, 1e-4);
+}
+
+TEST(CompareTests, TestMannWhitneyUWithTies)
+{
+    const auto result = sage::performance::statistics::mann_whitney_u({1, 2, 2, 3}, {2, 3, 3, 4});
+
+    ASSERT_DOUBLE_EQ(result.u, 3.0);
+    ASSERT_GT(result.p_value, 0.05);
+    ASSERT_DOUBLE_EQ(sage::performance::statistics::mann_whitney_u({5, 5}, {5, 5}).p_value, 1.0);
+    ASSERT_TRUE(std::isnan(sage::performance::statistics::mann_whitney_u({}, {1}).p_value));
+}
+
+TEST(CompareTests, TestPercentileInterpolates)
+{
+    ASSERT_DOUBLE_EQ(sage::performance::statistics::percentile({4, 1, 3, 2}, 50.0), 2.5);
+    ASSERT_DOUBLE_EQ(sage::performance::statistics::percentile({4, 1, 3, 2}, 100.0), 4.0);
+    ASSERT_DOUBLE_EQ(sage::performance::statistics::percentile({4, 1, 3, 2}, 0.0), 1.0);
+}
+
+TEST(CompareTests, TestBootstrapIntervalContainsRatio)
+{
+    const auto baseline = noisy_samples(200.0, 50, 1);
+    const auto candidate = noisy_samples(100.0, 50, 2);
+    const auto interval = sage::performance::statistics::bootstrap_median_ratio(baseline, candidate);
+
+    ASSERT_LT(interval.lower, 2.0);
+    ASSERT_GT(interval.upper, 2.0);
+    ASSERT_GT(interval.lower, 1.8);
+    ASSERT_LT(interval.upper, 2.2);
+}
+
+TEST(CompareTests, TestCompareVerdicts)
+{
+    const auto baseline = noisy_samples(100.0, 30, 3);
+    const auto slower = sage::performance::compare_measurements("slower", baseline, noisy_samples(120.0, 30, 4));
+    const auto faster = sage::performance::compare_measurements("faster", baseline, noisy_samples(80.0, 30, 5));
+    const auto same = sage::performance::compare_measurements("same", baseline, noisy_samples(100.0, 30, 6));
+
+    ASSERT_EQ(slower.verdict, sage::performance::comparison_verdict::slower);
+    ASSERT_LT(slower.speedup, 1.0);
+    ASSERT_EQ(faster.verdict, sage::performance::comparison_verdict::faster);
+    ASSERT_GT(faster.speedup, 1.0);
+    ASSERT_EQ(same.verdict, sage::performance::comparison_verdict::unchanged);
+
+    sage::performance::compare_options options;
+    options.threshold = 0.5;
+    ASSERT_EQ(sage::performance::compare_measurements("slower", baseline, noisy_samples(120.0, 30, 4), options).verdict, sage::performance::comparison_verdict::unchanged);
+}
+
+TEST(CompareTests, TestCompareSetsReportsMissingNames)
+{
+    const sage::performance::measurement_sets baseline = {{"a", {1, 2, 3}}, {"b", {1, 2, 3}}};
+    const sage::performance::measurement_sets candidate = {{"b", {1, 2, 3}}, {"c", {1, 2, 3}}};
+    const auto results = sage::performance::compare_measurements(baseline, candidate);
+
+    ASSERT_EQ(results.size(), 3);
+    ASSERT_EQ(results[0].verdict, sage::performance::comparison_verdict::only_in_baseline);
+    ASSERT_EQ(results[1].verdict, sage::performance::comparison_verdict::unchanged);
+    ASSERT_EQ(results[2].verdict, sage::performance::comparison_verdict::only_in_candidate);
+
+    std::stringstream table;
+    sage::performance::write_comparison_table(table, results, false);
+    ASSERT_THAT(table.str(), ::testing::HasSubstr("only in baseline"));
+    ASSERT_THAT(table.str(), ::testing::HasSubstr("unchanged"));
+    ASSERT_THAT(table.str(), ::testing::Not(::testing::HasSubstr("\033[")));
+}
+
+TEST(CompareTests, TestLoadMeasurementFormats)
+{
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto csv_path = directory / "sage_compare_bench.csv";
+    {
+        sage::performance::benchmark_result result{"bench,with comma", 10, {1.5, 2.5}};
+        std::ofstream file(csv_path);
+        sage::performance::write_benchmark_csv(file, {result});
+    }
+    const auto text_path = directory / "sage_compare_dump.txt";
+    {
+        std::ofstream file(text_path);
+        file << "0.5\n1.5\n";
+    }
+    const auto log_path = directory / "sage_compare_log.bin";
+    {
+        sage::performance::binary_log_writer writer(log_path);
+        sage::performance::binary_log_monitor monitor(writer, "logged");
+        monitor.add_measurement(std::chrono::microseconds(3));
+    }
+
+    ASSERT_THAT(sage::performance::load_measurements(csv_path)["bench,with comma"], ::testing::ElementsAre(1.5, 2.5));
+    ASSERT_THAT(sage::performance::load_measurements(text_path)["measurements"], ::testing::ElementsAre(500000.0, 1500000.0));
+    ASSERT_THAT(sage::performance::load_measurements(log_path)["logged"], ::testing::ElementsAre(3000.0));
+    ASSERT_THAT(sage::performance::load_measurements(text_path, "dump")["dump"], ::testing::ElementsAre(500000.0, 1500000.0));
+    ASSERT_THROW(sage::performance::load_measurements(directory / "sage_compare_missing.csv"), std::runtime_error);
+
+    std::filesystem::remove(csv_path);
+    std::filesystem::remove(text_path);
+    std::filesystem::remove(log_path);
+}
+
+TEST(CompareTests, TestCompareTextFilesWithDifferentNames)
+{
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto before_path = directory / "sage_compare_before.txt";
+    const auto after_path = directory / "sage_compare_after.txt";
+    {
+        std::ofstream before(before_path);
+        std::ofstream after(after_path);
+        for (const double value : noisy_samples(1.0, 30, 7))
+        {
+            before << value << "\n";
+        }
+        for (const double value : noisy_samples(2.0, 30, 8))
+        {
+            after << value << "\n";
+        }
+    }
+
+    const auto results = sage::performance::compare_measurements(sage::performance::load_measurements(before_path), sage::performance::load_measurements(after_path));
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].verdict, sage::performance::comparison_verdict::slower);
+    ASSERT_TRUE(sage::performance::any_compared(results));
+
+    std::filesystem::remove(before_path);
+    std::filesystem::remove(after_path);
+}
+
+TEST(CompareTests, TestNothingComparedWithoutCommonNames)
+{
+    const sage::performance::measurement_sets baseline = {{"a", {1, 2, 3}}};
+    const sage::performance::measurement_sets candidate = {{"b", {1, 2, 3}}};
+
+    ASSERT_FALSE(sage::performance::any_compared(sage::performance::compare_measurements(baseline, candidate)));
+}
+
+TEST(CompareTests, TestCsvLineWithoutColumnsIsRejected)
+{
+    const auto csv_path = std::filesystem::temp_directory_path() / "sage_compare_bad.csv";
+    {
+        std::ofstream file(csv_path);
+        file << "name,repetition,iterations,ns_per_iteration\n,3\n";
+    }
+
+    ASSERT_THROW(sage::performance::load_measurements(csv_path), std::runtime_error);
+    std::filesystem::remove(csv_path);
+}
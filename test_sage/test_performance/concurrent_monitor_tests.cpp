@@ -0,0 +1,96 @@
+#include <sage/performance/monitors.hpp>
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(ConcurrentPerformanceMonitorTests, TestConcurrentMonitorContainsMeasurementsAdded)
+{
+    sage::performance::concurrent_performance_monitor perf_monitor;
+    perf_monitor.add_measurement(std::chrono::milliseconds(100));
+    perf_monitor.add_measurement(std::chrono::milliseconds(200));
+    perf_monitor.add_measurement(std::chrono::milliseconds(300));
+
+    ASSERT_THAT(perf_monitor.get_measurements(), ::testing::ContainerEq(std::vector<double>({100, 200, 300})));
+    ASSERT_THAT(perf_monitor.total(), testing::DoubleEq(600));
+    ASSERT_THAT(perf_monitor.average(), testing::DoubleEq(200));
+    ASSERT_THAT(perf_monitor.s_total(), testing::StrEq("00:00:00:600"));
+}
+
+TEST(ConcurrentPerformanceMonitorTests, TestConcurrentMonitorMergesMeasurementsFromAllThreads)
+{
+    constexpr size_t thread_count = 8;
+    // Spans several storage chunks per thread
+    constexpr size_t measurements_per_thread = 5000;
+
+    sage::performance::concurrent_performance_monitor perf_monitor;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&perf_monitor]() {
+            for (size_t i = 0; i < measurements_per_thread; ++i)
+            {
+                perf_monitor.add_measurement(std::chrono::milliseconds(2));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto measurements = perf_monitor.get_measurements();
+    ASSERT_EQ(measurements.size(), thread_count * measurements_per_thread);
+    ASSERT_THAT(measurements, ::testing::Each(testing::DoubleEq(2)));
+    ASSERT_EQ(perf_monitor.count(), thread_count * measurements_per_thread);
+    ASSERT_THAT(perf_monitor.total(), testing::DoubleEq(2.0 * thread_count * measurements_per_thread));
+    ASSERT_THAT(perf_monitor.average(), testing::DoubleEq(2));
+}
+
+TEST(ConcurrentPerformanceMonitorTests, TestConcurrentMonitorCanBeReadWhileRecording)
+{
+    sage::performance::concurrent_performance_monitor perf_monitor;
+    std::atomic<bool> done = false;
+    std::thread writer([&perf_monitor, &done]() {
+        for (size_t i = 0; i < 20000; ++i)
+        {
+            perf_monitor.add_measurement(std::chrono::milliseconds(1));
+        }
+        done = true;
+    });
+
+    size_t last_count = 0;
+    while (!done)
+    {
+        const auto count = perf_monitor.get_measurements().size();
+        ASSERT_GE(count, last_count);
+        last_count = count;
+    }
+    writer.join();
+    ASSERT_EQ(perf_monitor.count(), 20000u);
+}
+
+TEST(ConcurrentPerformanceMonitorTests, TestThreadShardsReusedSlotGetsFreshShard)
+{
+    auto first = std::make_unique<sage::performance::detail::thread_shards<int>>();
+    first->local() = 42;
+    first.reset();
+
+    // Takes over the destroyed owner's slot, the calling thread's cached entry for it is stale
+    sage::performance::detail::thread_shards<int> second;
+    ASSERT_EQ(second.local(), 0);
+    size_t shards = 0;
+    second.for_each([&shards](int&) { ++shards; });
+    ASSERT_EQ(shards, 1u);
+}
+
+TEST(ConcurrentPerformanceMonitorTests, TestShortLivedMonitorsOnOneThread)
+{
+    for (int i = 0; i < 10000; ++i)
+    {
+        sage::performance::concurrent_performance_monitor monitor;
+        monitor.add_measurement(std::chrono::milliseconds(i));
+        ASSERT_THAT(monitor.get_measurements(), ::testing::ElementsAre(static_cast<double>(i)));
+    }
+}
@@ -0,0 +1,260 @@
+#include <sage/performance/coroutine_timer.hpp>
+#include <sage/performance/monitors.hpp>
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "test_clocks.hpp"
+
+namespace
+{
+    using sage_test::manual_clock;
+
+    // Runs queued coroutines one after another on the calling thread
+    class scheduler
+    {
+    public:
+        struct yield_awaiter
+        {
+            scheduler& owner;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                owner.m_ready.push_back(handle);
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        // Suspends the awaiting coroutine and queues it behind everything already queued
+        yield_awaiter yield()
+        {
+            return {*this};
+        }
+
+        void schedule(std::coroutine_handle<> handle)
+        {
+            m_ready.push_back(handle);
+        }
+
+        void run()
+        {
+            while (!m_ready.empty())
+            {
+                auto handle = m_ready.front();
+                m_ready.pop_front();
+                handle.resume();
+            }
+        }
+
+    private:
+        std::deque<std::coroutine_handle<>> m_ready;
+    };
+
+    // Lazily started task, timed from the first time it runs until it finishes
+    class task
+    {
+    public:
+        struct promise_type : sage::performance::basic_timed_promise<manual_clock>
+        {
+            using basic_timed_promise::basic_timed_promise;
+
+            task get_return_object()
+            {
+                return task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            auto initial_suspend()
+            {
+                return paused(std::suspend_always{});
+            }
+
+            std::suspend_always final_suspend() noexcept
+            {
+                stop_timing();
+                return {};
+            }
+
+            void return_void()
+            {
+            }
+
+            void unhandled_exception()
+            {
+                std::terminate();
+            }
+        };
+
+        explicit task(std::coroutine_handle<promise_type> handle) : m_handle(handle)
+        {
+        }
+
+        task(task&& other) noexcept : m_handle(std::exchange(other.m_handle, {}))
+        {
+        }
+
+        ~task()
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        [[nodiscard]] std::coroutine_handle<promise_type> handle() const
+        {
+            return m_handle;
+        }
+
+        [[nodiscard]] bool done() const
+        {
+            return m_handle.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    // Runs for `before`, yields to the scheduler, then runs for `after`
+    task work([[maybe_unused]] sage::performance::timer_monitor& monitor, scheduler& sched, std::chrono::milliseconds before, std::chrono::milliseconds after)
+    {
+        manual_clock::advance(before);
+        co_await sched.yield();
+        manual_clock::advance(after);
+    }
+
+    // Awaiter that decides in await_suspend not to suspend after all
+    struct not_suspending
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<>) const noexcept
+        {
+            manual_clock::advance(std::chrono::milliseconds(100));
+            return false;
+        }
+
+        int await_resume() const noexcept
+        {
+            return 7;
+        }
+    };
+
+    task not_suspending_work([[maybe_unused]] sage::performance::timer_monitor& monitor, int& result)
+    {
+        manual_clock::advance(std::chrono::milliseconds(1));
+        result = co_await not_suspending{};
+        manual_clock::advance(std::chrono::milliseconds(1));
+    }
+
+    task cancelled_work([[maybe_unused]] sage::performance::timer_monitor& monitor)
+    {
+        co_await std::suspend_never{};
+        manual_clock::advance(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(CoroutineTimerTests, TestSuspendedTimeIsNotMeasured)
+{
+    sage::performance::performance_monitor first_monitor;
+    sage::performance::performance_monitor second_monitor;
+    scheduler sched;
+    auto first = work(first_monitor, sched, std::chrono::milliseconds(2), std::chrono::milliseconds(3));
+    auto second = work(second_monitor, sched, std::chrono::milliseconds(10), std::chrono::milliseconds(20));
+    sched.schedule(first.handle());
+    sched.schedule(second.handle());
+    sched.run();
+
+    ASSERT_TRUE(first.done());
+    ASSERT_TRUE(second.done());
+    ASSERT_THAT(first_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(5.0)));
+    ASSERT_THAT(second_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(30.0)));
+}
+
+TEST(CoroutineTimerTests, TestTimeBeforeFirstResumeIsNotMeasured)
+{
+    sage::performance::performance_monitor perf_monitor;
+    scheduler sched;
+    auto t = work(perf_monitor, sched, std::chrono::milliseconds(1), std::chrono::milliseconds(1));
+    manual_clock::advance(std::chrono::milliseconds(50));
+    sched.schedule(t.handle());
+    sched.run();
+
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(2.0)));
+}
+
+TEST(CoroutineTimerTests, TestMeasurementIsReportedWhenCoroutineFinishes)
+{
+    sage::performance::performance_monitor perf_monitor;
+    scheduler sched;
+    auto t = work(perf_monitor, sched, std::chrono::milliseconds(1), std::chrono::milliseconds(1));
+    sched.schedule(t.handle());
+    sched.run();
+    manual_clock::advance(std::chrono::milliseconds(50));
+
+    ASSERT_TRUE(t.done());
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(2.0)));
+}
+
+TEST(CoroutineTimerTests, TestAwaiterThatDoesNotSuspendPassesResultThrough)
+{
+    sage::performance::performance_monitor perf_monitor;
+    int result = 0;
+    auto t = not_suspending_work(perf_monitor, result);
+    t.handle().resume();
+
+    ASSERT_TRUE(t.done());
+    ASSERT_EQ(result, 7);
+    // The time inside await_suspend is left out, as the timer is paused around it
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(2.0)));
+}
+
+TEST(CoroutineTimerTests, TestCancelledCoroutineTimingReportsNothing)
+{
+    sage::performance::performance_monitor perf_monitor;
+    auto t = cancelled_work(perf_monitor);
+    t.handle().promise().cancel_timing();
+    t.handle().resume();
+
+    ASSERT_TRUE(t.done());
+    ASSERT_TRUE(perf_monitor.get_measurements().empty());
+}
+
+TEST(CoroutineTimerTests, TestPausedWhileWrapsAwaitableForPlainTimer)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::performance_monitor other_monitor;
+    scheduler sched;
+    std::optional<sage::performance::basic_timer<manual_clock>> t;
+    auto body = [&]() -> task {
+        t.emplace(perf_monitor);
+        manual_clock::advance(std::chrono::milliseconds(1));
+        co_await sage::performance::paused_while(*t, sched.yield());
+        manual_clock::advance(std::chrono::milliseconds(1));
+        t.reset();
+    };
+    auto running = body();
+    auto other = work(other_monitor, sched, std::chrono::milliseconds(10), std::chrono::milliseconds(0));
+    sched.schedule(running.handle());
+    sched.schedule(other.handle());
+    sched.run();
+
+    ASSERT_TRUE(running.done());
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(2.0)));
+}
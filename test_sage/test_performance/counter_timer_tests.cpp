@@ -0,0 +1,63 @@
+#include <sage/performance/counter_timer.hpp>
+#include <sage/performance/benchmark.hpp>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(CounterTimerTests, TestCounterValuesDifference)
+{
+    const sage::performance::counter_values start{100, 200, 3, 4, true};
+    const sage::performance::counter_values end{300, 800, 5, 9, true};
+    const auto delta = end - start;
+
+    ASSERT_EQ(delta.cycles, 200);
+    ASSERT_EQ(delta.instructions, 600);
+    ASSERT_EQ(delta.cache_misses, 2);
+    ASSERT_EQ(delta.branch_misses, 5);
+    ASSERT_TRUE(delta.available);
+    ASSERT_DOUBLE_EQ(delta.instructions_per_cycle(), 3.0);
+    ASSERT_FALSE((end - sage::performance::counter_values{}).available);
+}
+
+TEST(CounterTimerTests, TestCounterSummaryMonitorTotals)
+{
+    sage::performance::counter_summary_monitor monitor;
+    monitor.add_measurement(std::chrono::milliseconds(10), {100, 150, 1, 2, true});
+    monitor.add_measurement(std::chrono::milliseconds(30), {100, 250, 3, 4, true});
+
+    ASSERT_EQ(monitor.count(), 2);
+    ASSERT_DOUBLE_EQ(monitor.total(), 40.0);
+    ASSERT_DOUBLE_EQ(monitor.average(), 20.0);
+    ASSERT_EQ(monitor.counters().cache_misses, 4);
+    ASSERT_EQ(monitor.counters().branch_misses, 6);
+    ASSERT_DOUBLE_EQ(monitor.instructions_per_cycle(), 2.0);
+}
+
+TEST(CounterTimerTests, TestCounterTimerMeasuresOrFallsBackToTime)
+{
+    sage::performance::counter_summary_monitor monitor;
+    {
+        sage::performance::counter_timer t(monitor);
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < 100000; ++i)
+        {
+            sum += i;
+            sage::performance::do_not_optimize(sum);
+        }
+    }
+
+    ASSERT_EQ(monitor.count(), 1);
+    ASSERT_GT(monitor.total(), 0.0);
+    const auto& counters = monitor.counters();
+    ASSERT_EQ(counters.available, sage::performance::perf_counter_group::local().available());
+    if (counters.available)
+    {
+        ASSERT_GT(counters.instructions, 100000);
+        ASSERT_GT(counters.cycles, 0);
+    }
+    else
+    {
+        ASSERT_EQ(counters.instructions, 0);
+        ASSERT_EQ(counters.cycles, 0);
+    }
+}
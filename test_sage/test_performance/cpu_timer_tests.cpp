@@ -0,0 +1,85 @@
+#include <sage/performance/cpu_timer.hpp>
+#include <sage/performance/benchmark.hpp>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    // Spins until the calling thread has used the given CPU time, however busy the machine is
+    void spin_for(std::chrono::milliseconds duration)
+    {
+        const auto end = sage::performance::thread_cpu_clock::now() + duration;
+        uint64_t counter = 0;
+        while (sage::performance::thread_cpu_clock::now() < end)
+        {
+            sage::performance::do_not_optimize(++counter);
+        }
+    }
+}
+
+TEST(CpuTimerTests, TestThreadCpuClockIgnoresSleep)
+{
+    sage::performance::performance_monitor spin_monitor;
+    sage::performance::performance_monitor sleep_monitor;
+    {
+        sage::performance::thread_cpu_timer t(spin_monitor);
+        spin_for(std::chrono::milliseconds(50));
+    }
+    {
+        sage::performance::thread_cpu_timer t(sleep_monitor);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    ASSERT_GE(spin_monitor.total(), 50.0);
+    ASSERT_LT(sleep_monitor.total(), 10.0);
+}
+
+TEST(CpuTimerTests, TestProcessCpuClockCountsOtherThreads)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        sage::performance::process_cpu_timer t(perf_monitor);
+        std::thread worker([]() { spin_for(std::chrono::milliseconds(50)); });
+        worker.join();
+    }
+
+    ASSERT_GE(perf_monitor.total(), 50.0);
+}
+
+TEST(CpuTimerTests, TestCpuTimerSeparatesWaitingFromComputing)
+{
+    sage::performance::cpu_summary_monitor computing;
+    sage::performance::cpu_summary_monitor waiting;
+    {
+        sage::performance::cpu_timer t(computing);
+        spin_for(std::chrono::milliseconds(100));
+    }
+    {
+        sage::performance::cpu_timer t(waiting);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    ASSERT_EQ(computing.count(), 1);
+    ASSERT_GE(computing.total_wall(), 100.0);
+    // getrusage can round to a coarser unit than the thread clock
+    ASSERT_GT(computing.totals().cpu(), std::chrono::milliseconds(90));
+    ASSERT_GE(waiting.total_wall(), 100.0);
+    ASSERT_LT(waiting.cpu_utilisation(), 0.2);
+    ASSERT_THAT(computing.s_summary(), ::testing::HasSubstr("user"));
+}
+
+TEST(CpuTimerTests, TestCpuSummaryMonitorTotals)
+{
+    sage::performance::cpu_summary_monitor monitor;
+    monitor.add_measurement({std::chrono::milliseconds(10), std::chrono::milliseconds(4), std::chrono::milliseconds(1)});
+    monitor.add_measurement({std::chrono::milliseconds(30), std::chrono::milliseconds(10), std::chrono::milliseconds(5)});
+
+    ASSERT_EQ(monitor.count(), 2);
+    ASSERT_DOUBLE_EQ(monitor.total_wall(), 40.0);
+    ASSERT_DOUBLE_EQ(monitor.total_user(), 14.0);
+    ASSERT_DOUBLE_EQ(monitor.total_system(), 6.0);
+    ASSERT_DOUBLE_EQ(monitor.cpu_utilisation(), 0.5);
+}
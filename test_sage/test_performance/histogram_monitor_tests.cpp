@@ -0,0 +1,131 @@
+#include <sage/performance/histogram_monitor.hpp>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    // Records 1us, 2us ... count us
+    void add_linear_measurements(sage::performance::histogram_monitor& monitor, int count)
+    {
+        for (int i = 1; i <= count; ++i)
+        {
+            monitor.add_measurement(std::chrono::microseconds(i));
+        }
+    }
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorPercentilesAreWithinPrecision)
+{
+    sage::performance::histogram_monitor monitor;
+    add_linear_measurements(monitor, 10000);
+
+    // 3 significant digits, values are in ms
+    ASSERT_EQ(monitor.count(), 10000u);
+    ASSERT_THAT(monitor.p50(), testing::DoubleNear(5.0, 5.0 * 1e-3));
+    ASSERT_THAT(monitor.p90(), testing::DoubleNear(9.0, 9.0 * 1e-3));
+    ASSERT_THAT(monitor.p99(), testing::DoubleNear(9.9, 9.9 * 1e-3));
+    ASSERT_THAT(monitor.p999(), testing::DoubleNear(9.99, 9.99 * 1e-3));
+    ASSERT_THAT(monitor.value_at_percentile(100.0), testing::DoubleEq(10.0));
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorTracksExactMinMaxAndAverage)
+{
+    sage::performance::histogram_monitor monitor;
+    monitor.add_measurement(std::chrono::microseconds(1234));
+    monitor.add_measurement(std::chrono::microseconds(5678));
+    monitor.add_measurement(std::chrono::microseconds(91011));
+
+    ASSERT_THAT(monitor.min(), testing::DoubleEq(1.234));
+    ASSERT_THAT(monitor.max(), testing::DoubleEq(91.011));
+    ASSERT_THAT(monitor.total(), testing::DoubleEq(97.923));
+    ASSERT_THAT(monitor.average(), testing::DoubleEq(97.923 / 3));
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorEmptyStatistics)
+{
+    sage::performance::histogram_monitor monitor;
+
+    ASSERT_EQ(monitor.count(), 0u);
+    ASSERT_TRUE(std::isnan(monitor.p50()));
+    ASSERT_TRUE(std::isnan(monitor.min()));
+    ASSERT_TRUE(std::isnan(monitor.max()));
+    ASSERT_TRUE(std::isnan(monitor.average()));
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorClampsValuesOutsideRange)
+{
+    sage::performance::histogram_monitor monitor(std::chrono::microseconds(1), std::chrono::seconds(1), 2);
+    monitor.add_measurement(std::chrono::seconds(10));
+
+    ASSERT_THAT(monitor.max(), testing::DoubleEq(1000));
+    ASSERT_THAT(monitor.p50(), testing::DoubleEq(1000));
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorMemoryIsBoundedByConfiguration)
+{
+    sage::performance::histogram_monitor monitor;
+    const auto bucket_count = monitor.bucket_count();
+    add_linear_measurements(monitor, 100000);
+
+    ASSERT_EQ(monitor.bucket_count(), bucket_count);
+    ASSERT_LT(sage::performance::histogram_monitor(std::chrono::microseconds(1), std::chrono::minutes(1), 2).bucket_count(), bucket_count);
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorMergeMatchesSingleMonitor)
+{
+    sage::performance::histogram_monitor combined;
+    sage::performance::histogram_monitor first;
+    sage::performance::histogram_monitor second;
+    for (int i = 1; i <= 1000; ++i)
+    {
+        combined.add_measurement(std::chrono::microseconds(i * 7));
+        (i % 2 == 0 ? first : second).add_measurement(std::chrono::microseconds(i * 7));
+    }
+    first.merge(second);
+
+    ASSERT_EQ(first.count(), combined.count());
+    ASSERT_THAT(first.p50(), testing::DoubleEq(combined.p50()));
+    ASSERT_THAT(first.p99(), testing::DoubleEq(combined.p99()));
+    ASSERT_THAT(first.min(), testing::DoubleEq(combined.min()));
+    ASSERT_THAT(first.max(), testing::DoubleEq(combined.max()));
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorMergeWithDifferentConfigurationThrows)
+{
+    sage::performance::histogram_monitor first;
+    sage::performance::histogram_monitor second(std::chrono::microseconds(1), std::chrono::minutes(1), 2);
+
+    ASSERT_THROW(first.merge(second), std::invalid_argument);
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorInvalidConfigurationThrows)
+{
+    ASSERT_THROW(sage::performance::histogram_monitor(std::chrono::nanoseconds(0)), std::invalid_argument);
+    ASSERT_THROW(sage::performance::histogram_monitor(std::chrono::seconds(1), std::chrono::seconds(1)), std::invalid_argument);
+    ASSERT_THROW(sage::performance::histogram_monitor(std::chrono::microseconds(1), std::chrono::minutes(1), 6), std::invalid_argument);
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorReset)
+{
+    sage::performance::histogram_monitor monitor;
+    add_linear_measurements(monitor, 100);
+    monitor.reset();
+
+    ASSERT_EQ(monitor.count(), 0u);
+    monitor.add_measurement(std::chrono::microseconds(3));
+    ASSERT_THAT(monitor.p50(), testing::DoubleEq(0.003));
+    ASSERT_THAT(monitor.min(), testing::DoubleEq(0.003));
+}
+
+TEST(HistogramMonitorTests, TestHistogramMonitorWorksWithTimer)
+{
+    sage::performance::histogram_monitor monitor;
+    for (int i = 0; i < 10; ++i)
+    {
+        sage::performance::measure(monitor, [](){});
+    }
+
+    ASSERT_EQ(monitor.count(), 10u);
+    ASSERT_LE(monitor.p50(), monitor.max());
+}
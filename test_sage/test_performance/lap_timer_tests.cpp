@@ -0,0 +1,98 @@
+#include <sage/performance/lap_timer.hpp>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    enum class pipeline_phase
+    {
+        parse,
+        lookup,
+        compute
+    };
+}
+
+TEST(LapTimerTests, TestLapTimerAttributesIntervalsToPhases)
+{
+    sage::performance::multi_series_monitor monitor;
+    const auto first = monitor.add_series("first");
+    const auto second = monitor.add_series("second");
+    {
+        sage::performance::lap_timer laps(monitor);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        laps.lap(first);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        laps.lap(second);
+    }
+
+    ASSERT_EQ(monitor.series_count(), 2);
+    ASSERT_EQ(monitor.name(second), "second");
+    ASSERT_EQ(monitor.series(first).count(), 1);
+    ASSERT_EQ(monitor.series(second).count(), 1);
+    ASSERT_GE(monitor.series(first).total(), 10.0);
+    ASSERT_LT(monitor.series(first).total(), 30.0);
+    ASSERT_GE(monitor.series(second).total(), 30.0);
+    ASSERT_DOUBLE_EQ(monitor.total(), monitor.series(first).total() + monitor.series(second).total());
+}
+
+TEST(LapTimerTests, TestLapTimerWithEnumPhases)
+{
+    sage::performance::multi_series_monitor monitor({"parse", "lookup", "compute"});
+    for (int i = 0; i < 5; ++i)
+    {
+        sage::performance::lap_timer laps(monitor);
+        laps.lap(pipeline_phase::parse);
+        laps.lap(pipeline_phase::lookup);
+        laps.lap(pipeline_phase::compute);
+    }
+
+    for (size_t phase = 0; phase < monitor.series_count(); ++phase)
+    {
+        ASSERT_EQ(monitor.series(phase).count(), 5);
+    }
+    const auto report = monitor.report_string();
+    ASSERT_THAT(report, ::testing::HasSubstr("parse"));
+    ASSERT_THAT(report, ::testing::HasSubstr("compute"));
+    ASSERT_THAT(report, ::testing::HasSubstr("%"));
+}
+
+TEST(LapTimerTests, TestLapTimerToPerPhaseMonitors)
+{
+    sage::performance::performance_monitor parse_monitor;
+    sage::performance::performance_monitor compute_monitor;
+    sage::performance::phase_monitors monitors({parse_monitor, compute_monitor});
+    {
+        sage::performance::lap_timer laps(monitors);
+        laps.lap(0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        laps.restart();
+        laps.lap(1);
+        laps.lap(1);
+    }
+
+    ASSERT_EQ(parse_monitor.get_measurements().size(), 1);
+    ASSERT_EQ(compute_monitor.get_measurements().size(), 2);
+    // The sleep was skipped by restart
+    ASSERT_LT(compute_monitor.total(), 20.0);
+}
+
+TEST(LapTimerTests, TestLapForUnregisteredPhaseIsIgnored)
+{
+    sage::performance::multi_series_monitor series({"parse"});
+    sage::performance::performance_monitor parse_monitor;
+    sage::performance::phase_monitors monitors({parse_monitor});
+    {
+        sage::performance::lap_timer series_laps(series);
+        sage::performance::lap_timer monitor_laps(monitors);
+        series_laps.lap(pipeline_phase::compute);
+        monitor_laps.lap(pipeline_phase::compute);
+        series_laps.lap(pipeline_phase::parse);
+        monitor_laps.lap(pipeline_phase::parse);
+    }
+
+    ASSERT_EQ(series.series(0).count(), 1);
+    ASSERT_EQ(parse_monitor.get_measurements().size(), 1);
+}
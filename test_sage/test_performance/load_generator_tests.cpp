@@ -0,0 +1,77 @@
+#include <sage/performance/load_generator.hpp>
+#include <sage/performance/histogram_monitor.hpp>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(LoadGeneratorTests, TestIssuesRequestsAtTargetRate)
+{
+    sage::performance::histogram_monitor latency;
+    std::vector<size_t> indices;
+    const auto result = sage::performance::run_load([&indices](size_t index) { indices.push_back(index); },
+                                                    latency, {2000.0, std::chrono::milliseconds(50)});
+
+    ASSERT_EQ(result.requests, 100u);
+    ASSERT_EQ(indices.size(), 100u);
+    ASSERT_EQ(indices.front(), 0u);
+    ASSERT_EQ(indices.back(), 99u);
+    ASSERT_EQ(latency.count(), 100u);
+    ASSERT_DOUBLE_EQ(result.target_rate, 2000.0);
+    ASSERT_GT(result.achieved_rate, 1500.0);
+    ASSERT_LE(result.achieved_rate, 2000.0);
+    // The last request is meant to start 49.5ms in
+    ASSERT_GE(result.elapsed, std::chrono::microseconds(49500));
+}
+
+TEST(LoadGeneratorTests, TestStallCountsAgainstEveryDelayedRequest)
+{
+    sage::performance::histogram_monitor latency;
+    sage::performance::histogram_monitor service;
+    // One request stalls for 50 intervals
+    const auto result = sage::performance::run_load([](size_t index) {
+        if (index == 50)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }, latency, {1000.0, std::chrono::milliseconds(200)}, &service);
+
+    ASSERT_EQ(service.count(), 200u);
+    ASSERT_EQ(latency.count(), 200u);
+    // Service times only see the one slow call, the latencies of the requests queued up behind
+    // it grow as far as the stall
+    ASSERT_LT(service.value_at_percentile(99.0), 10.0);
+    ASSERT_GT(latency.value_at_percentile(80.0), 10.0);
+    ASSERT_GE(latency.max(), 50.0);
+    ASSERT_GE(result.max_start_delay, std::chrono::milliseconds(40));
+}
+
+TEST(LoadGeneratorTests, TestSlowCallableAchievesLessThanTarget)
+{
+    sage::performance::histogram_monitor latency;
+    const auto result = sage::performance::run_load([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }, latency, {1000.0, std::chrono::milliseconds(20)});
+
+    ASSERT_EQ(result.requests, 20u);
+    ASSERT_LT(result.achieved_rate, 600.0);
+    ASSERT_GE(result.elapsed, std::chrono::milliseconds(40));
+}
+
+TEST(LoadGeneratorTests, TestInvalidOptionsThrow)
+{
+    sage::performance::histogram_monitor latency;
+
+    ASSERT_THROW(sage::performance::run_load([]() {}, latency, {0.0, std::chrono::seconds(1)}), std::invalid_argument);
+    ASSERT_THROW(sage::performance::run_load([]() {}, latency, {100.0, std::chrono::seconds(0)}), std::invalid_argument);
+}
+
+TEST(LoadGeneratorTests, TestLoadSummaryString)
+{
+    sage::performance::load_result result{10000, 1000.0, 1000.0, std::chrono::seconds(10), std::chrono::nanoseconds(12340)};
+
+    ASSERT_EQ(result.s_summary(), "10000 requests in 10.00s, achieved 1000.00/s of 1000.00/s target, max start delay 12.34us");
+}
@@ -0,0 +1,139 @@
+#include <sage/performance/memory_timer.hpp>
+#include <sage/performance/histogram_monitor.hpp>
+
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(MemoryTimerTests, TestDifferenceBetweenSamples)
+{
+    const sage::performance::memory_sample start{1000, 2000, 10, 1, true};
+    const sage::performance::memory_sample end{1500, 2500, 25, 1, true};
+    const auto measurement = sage::performance::memory_difference(start, end, std::chrono::milliseconds(3));
+
+    ASSERT_EQ(measurement.duration, std::chrono::milliseconds(3));
+    ASSERT_EQ(measurement.rss_delta, 500);
+    ASSERT_EQ(measurement.peak_rss, 2500);
+    ASSERT_EQ(measurement.peak_rss_delta, 500);
+    ASSERT_EQ(measurement.minor_faults, 15);
+    ASSERT_EQ(measurement.major_faults, 0);
+}
+
+TEST(MemoryTimerTests, TestSummaryMonitorTotalsAndPeaks)
+{
+    sage::performance::memory_summary_monitor monitor;
+    monitor.add_measurement({std::chrono::milliseconds(1), -4000000, 250000000, 0, 10, 0});
+    monitor.add_measurement({std::chrono::milliseconds(1), 16000000, 240000000, 0, 3062, 0});
+
+    ASSERT_EQ(monitor.count(), 2u);
+    ASSERT_EQ(monitor.total_rss_delta(), 12000000);
+    ASSERT_EQ(monitor.largest_rss_delta(), 16000000);
+    ASSERT_EQ(monitor.peak_rss(), 250000000);
+    ASSERT_EQ(monitor.minor_faults(), 3072);
+    ASSERT_DOUBLE_EQ(monitor.average_minor_faults(), 1536.0);
+    ASSERT_EQ(monitor.s_summary(), "rss +12.00 MB (largest +16.00 MB), peak 250.00 MB, 3072 minor faults, 0 major faults");
+}
+
+TEST(MemoryTimerTests, TestValueMonitorForwardsToTimerMonitor)
+{
+    sage::performance::histogram_monitor faults;
+    sage::performance::performance_monitor durations;
+    sage::performance::memory_value_monitor fault_values(faults, sage::performance::memory_value::minor_faults);
+    sage::performance::memory_value_monitor duration_values(durations, sage::performance::memory_value::duration);
+    const sage::performance::memory_measurement measurement{std::chrono::milliseconds(2), -4096, 8192, 0, 12, 1};
+    fault_values.add_measurement(measurement);
+    duration_values.add_measurement(measurement);
+
+    ASSERT_EQ(faults.count(), 1u);
+    // Carried as 12ns, which monitors report as 12e-6ms
+    ASSERT_DOUBLE_EQ(faults.max(), 12e-6);
+    ASSERT_THAT(durations.get_measurements(), ::testing::ElementsAre(2.0));
+}
+
+TEST(MemoryTimerTests, TestBytesAreFormattedWithSiPrefixes)
+{
+    ASSERT_EQ(sage::performance::format_bytes(512.0), "512.00 B");
+    ASSERT_EQ(sage::performance::format_bytes(1234567.0), "1.23 MB");
+}
+
+#if defined(__linux__)
+TEST(MemoryTimerTests, TestReadMemorySample)
+{
+    const auto sample = sage::performance::read_memory_sample();
+
+    ASSERT_TRUE(sample.available);
+    ASSERT_GT(sample.rss, 0);
+    ASSERT_GT(sample.peak_rss, 0);
+    ASSERT_GT(sample.minor_faults, 0);
+}
+
+TEST(MemoryTimerTests, TestReadMemoryStatus)
+{
+    const auto status = sage::performance::read_memory_status();
+
+    ASSERT_TRUE(status.available);
+    ASSERT_GT(status.rss, 0);
+    ASSERT_GE(status.peak_rss, status.rss);
+    ASSERT_GE(status.virtual_size, status.rss);
+    ASSERT_GE(status.peak_virtual_size, status.virtual_size);
+}
+
+TEST(MemoryTimerTests, TestForkedChildReadsItsOwnMemory)
+{
+    // Opens the statm file in the parent first
+    const auto parent = sage::performance::read_memory_sample();
+    ASSERT_TRUE(parent.available);
+
+    const pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        constexpr size_t size = 64 * 1024 * 1024;
+        std::vector<char> buffer(size, 1);
+        const auto sample = sage::performance::read_memory_sample();
+        _exit(sample.available && sample.rss > parent.rss + static_cast<int64_t>(size / 2) && buffer.back() == 1 ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(MemoryTimerTests, TestMemoryTimerSeesTouchedMemory)
+{
+    constexpr size_t size = 64 * 1024 * 1024;
+    sage::performance::memory_summary_monitor monitor;
+    std::vector<char> buffer;
+    {
+        sage::performance::memory_timer t(monitor);
+        // Constructing with a value writes to every page
+        buffer = std::vector<char>(size, 1);
+    }
+
+    ASSERT_EQ(monitor.count(), 1u);
+    ASSERT_GT(monitor.total_rss_delta(), static_cast<int64_t>(size / 2));
+    ASSERT_GT(monitor.minor_faults(), 1000);
+    ASSERT_GE(monitor.peak_rss(), static_cast<int64_t>(size));
+}
+#endif
+
+TEST(MemoryTimerTests, TestSamplerReportsEverySample)
+{
+    sage::performance::memory_summary_monitor monitor;
+    sage::performance::memory_sampler sampler(monitor, std::chrono::milliseconds(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    sampler.stop();
+
+    ASSERT_GE(sampler.samples(), 2u);
+    ASSERT_EQ(monitor.count(), sampler.samples());
+#if defined(__linux__)
+    ASSERT_TRUE(sampler.latest().available);
+#endif
+}
@@ -0,0 +1,103 @@
+#include <sage/performance/monitor_registry.hpp>
+#include <sage/performance/timer.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(MonitorRegistryTests, TestRegistryReturnsSameMonitorForName)
+{
+    sage::performance::monitor_registry registry;
+    auto& first = registry.get("requests", "Time to handle a request");
+    auto& second = registry.get("requests");
+
+    ASSERT_EQ(&first, &second);
+    ASSERT_EQ(registry.find("requests"), &first);
+    ASSERT_EQ(registry.find("missing"), nullptr);
+    ASSERT_EQ(registry.size(), 1);
+    ASSERT_EQ(first.help(), "Time to handle a request");
+}
+
+TEST(MonitorRegistryTests, TestRegistryRejectsInvalidNamesAndOverflow)
+{
+    sage::performance::monitor_registry registry(2);
+    ASSERT_THROW(registry.get("1bad"), std::invalid_argument);
+    ASSERT_THROW(registry.get("has space"), std::invalid_argument);
+    ASSERT_THROW(registry.get(""), std::invalid_argument);
+
+    registry.get("a");
+    registry.get("b:c");
+    ASSERT_THROW(registry.get("d"), std::runtime_error);
+    ASSERT_NO_THROW(registry.get("a"));
+}
+
+TEST(MonitorRegistryTests, TestRegistrySnapshotMergesThreads)
+{
+    sage::performance::monitor_registry registry;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&registry]() {
+            for (int i = 0; i < 1000; ++i)
+            {
+                registry.get("work").add_measurement(std::chrono::milliseconds(1));
+                sage::performance::timer timer(registry.get("timed"));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto snapshot = registry.snapshot();
+    ASSERT_EQ(snapshot.monitors.size(), 2);
+    for (const auto& monitor : snapshot.monitors)
+    {
+        ASSERT_EQ(monitor.histogram.count(), 4000);
+    }
+    ASSERT_EQ(registry.get("work").snapshot().count(), 4000);
+}
+
+TEST(MonitorRegistryTests, TestPrometheusText)
+{
+    sage::performance::monitor_registry registry;
+    auto& requests = registry.get("http_requests", "Request latency");
+    for (int i = 0; i < 10; ++i)
+    {
+        requests.add_measurement(std::chrono::milliseconds(100));
+    }
+    registry.get("idle");
+
+    const auto text = registry.prometheus_string();
+    ASSERT_THAT(text, ::testing::HasSubstr("# HELP http_requests_seconds Request latency\n"));
+    ASSERT_THAT(text, ::testing::HasSubstr("# TYPE http_requests_seconds summary\n"));
+    ASSERT_THAT(text, ::testing::HasSubstr("http_requests_seconds{quantile=\"0.99\"} 0.1"));
+    ASSERT_THAT(text, ::testing::HasSubstr("http_requests_seconds_sum 1\n"));
+    ASSERT_THAT(text, ::testing::HasSubstr("http_requests_seconds_count 10\n"));
+    ASSERT_THAT(text, ::testing::HasSubstr("idle_seconds{quantile=\"0.5\"} NaN\n"));
+    ASSERT_THAT(text, ::testing::HasSubstr("idle_seconds_count 0\n"));
+}
+
+TEST(MonitorRegistryTests, TestPrometheusFileIsReplaced)
+{
+    sage::performance::monitor_registry registry;
+    registry.get("written").add_measurement(std::chrono::seconds(1));
+    const auto path = std::filesystem::temp_directory_path() / "sage_monitor_registry_test.prom";
+    {
+        std::ofstream stale(path);
+        stale << "stale";
+    }
+    registry.write_prometheus(path);
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    ASSERT_EQ(contents.str(), registry.prometheus_string());
+    ASSERT_FALSE(std::filesystem::exists(std::filesystem::path(path) += ".tmp"));
+    std::filesystem::remove(path);
+}
@@ -74,4 +74,54 @@ TEST(PerformanceMonitorTests, TestPerformanceMonitorSAverageIsCorrectPadding)
     perf_monitor.add_measurement(std::chrono::milliseconds(42));
 
     ASSERT_THAT(perf_monitor.s_average(), testing::StrEq("00:00:00:038"));
-}
\ No newline at end of file
+}
+
+TEST(PerformanceMonitorTests, TestPerformanceMonitorKeepsSubMillisecondMeasurements)
+{
+    sage::performance::performance_monitor perf_monitor;
+    perf_monitor.add_measurement(std::chrono::microseconds(250));
+    perf_monitor.add_measurement(std::chrono::nanoseconds(1500));
+
+    ASSERT_THAT(perf_monitor.get_measurements(), ::testing::ElementsAre(testing::DoubleEq(0.25), testing::DoubleEq(0.0015)));
+}
+
+TEST(PerformanceMonitorTests, TestTimerReportsNonZeroSubMillisecondDuration)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        sage::performance::timer t(perf_monitor);
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    ASSERT_EQ(perf_monitor.get_measurements().size(), 1u);
+    ASSERT_GT(perf_monitor.total(), 0.0);
+}
+
+class millisecond_recording_monitor final : public sage::performance::millisecond_timer_monitor
+{
+public:
+    void add_measurement(std::chrono::milliseconds duration_in_ms) override
+    {
+        measurements.push_back(duration_in_ms.count());
+    }
+
+    std::vector<std::chrono::milliseconds::rep> measurements;
+};
+
+TEST(PerformanceMonitorTests, TestMillisecondAdaptorForwardsTruncatedMeasurements)
+{
+    millisecond_recording_monitor ms_monitor;
+    sage::performance::millisecond_adaptor adaptor(ms_monitor);
+    adaptor.add_measurement(std::chrono::microseconds(2500));
+    adaptor.add_measurement(std::chrono::microseconds(999));
+
+    ASSERT_THAT(ms_monitor.measurements, ::testing::ElementsAre(2, 0));
+}
+
+TEST(PerformanceMonitorTests, TestMillisecondTimerReportsToMillisecondMonitor)
+{
+    millisecond_recording_monitor ms_monitor;
+    sage::performance::measure(ms_monitor, [](){});
+
+    ASSERT_EQ(ms_monitor.measurements.size(), 1u);
+}
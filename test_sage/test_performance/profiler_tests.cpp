@@ -0,0 +1,117 @@
+#include <sage/performance/profiler.hpp>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    const sage::performance::profile_report_node* find_child(const sage::performance::profile_report_node& node, const std::string& name)
+    {
+        for (const auto& child : node.children)
+        {
+            if (child.name == name)
+            {
+                return &child;
+            }
+        }
+        return nullptr;
+    }
+
+    void leaf_work()
+    {
+        SAGE_PROFILE_ZONE("profiler_test_leaf");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(ProfilerTests, TestProfileZonesBuildNestedCallTree)
+{
+    sage::performance::profiler::instance().reset();
+    {
+        SAGE_PROFILE_ZONE("profiler_test_root");
+        for (int i = 0; i < 3; ++i)
+        {
+            leaf_work();
+        }
+        {
+            SAGE_PROFILE_ZONE("profiler_test_other");
+        }
+    }
+
+    const auto report = sage::performance::profiler::instance().report();
+    const auto* root = find_child(report, "profiler_test_root");
+    ASSERT_NE(root, nullptr);
+    ASSERT_EQ(root->calls, 1u);
+    ASSERT_EQ(root->children.size(), 2u);
+
+    const auto* leaf = find_child(*root, "profiler_test_leaf");
+    ASSERT_NE(leaf, nullptr);
+    ASSERT_EQ(leaf->calls, 3u);
+    ASSERT_GE(leaf->inclusive, std::chrono::milliseconds(3));
+    ASSERT_EQ(leaf->exclusive, leaf->inclusive);
+
+    const auto* other = find_child(*root, "profiler_test_other");
+    ASSERT_NE(other, nullptr);
+    ASSERT_EQ(other->calls, 1u);
+
+    ASSERT_GE(root->inclusive, leaf->inclusive + other->inclusive);
+    ASSERT_EQ(root->exclusive, root->inclusive - leaf->inclusive - other->inclusive);
+    // Children are ordered by inclusive time
+    ASSERT_EQ(root->children.front().name, "profiler_test_leaf");
+}
+
+TEST(ProfilerTests, TestProfileZonesMergeAcrossThreads)
+{
+    sage::performance::profiler::instance().reset();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([]() {
+            SAGE_PROFILE_ZONE("profiler_test_thread_root");
+            leaf_work();
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto report = sage::performance::profiler::instance().report();
+    const auto* root = find_child(report, "profiler_test_thread_root");
+    ASSERT_NE(root, nullptr);
+    ASSERT_EQ(root->calls, 4u);
+    const auto* leaf = find_child(*root, "profiler_test_leaf");
+    ASSERT_NE(leaf, nullptr);
+    ASSERT_EQ(leaf->calls, 4u);
+}
+
+TEST(ProfilerTests, TestProfilerFoldedStacksAndReport)
+{
+    sage::performance::profiler::instance().reset();
+    {
+        SAGE_PROFILE_ZONE("profiler_test_folded");
+        leaf_work();
+    }
+
+    const auto folded = sage::performance::profiler::instance().folded_stacks_string();
+    ASSERT_THAT(folded, ::testing::HasSubstr("profiler_test_folded;profiler_test_leaf "));
+
+    const auto report = sage::performance::profiler::instance().report_string();
+    ASSERT_THAT(report, ::testing::HasSubstr("profiler_test_folded"));
+    ASSERT_THAT(report, ::testing::HasSubstr("  profiler_test_leaf"));
+}
+
+TEST(ProfilerTests, TestProfilerResetClearsCounts)
+{
+    {
+        SAGE_PROFILE_ZONE("profiler_test_reset");
+    }
+    sage::performance::profiler::instance().reset();
+
+    const auto report = sage::performance::profiler::instance().report();
+    const auto* node = find_child(report, "profiler_test_reset");
+    ASSERT_NE(node, nullptr);
+    ASSERT_EQ(node->calls, 0u);
+}
@@ -0,0 +1,144 @@
+#include <sage/performance/sampling_monitor.hpp>
+#include <sage/performance/monitors.hpp>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    // Clock that counts how often it is read and advances a millisecond per read
+    struct counting_clock
+    {
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<counting_clock>;
+        static constexpr bool is_steady = true;
+
+        static inline int reads = 0;
+
+        static time_point now()
+        {
+            ++reads;
+            return time_point(std::chrono::milliseconds(reads));
+        }
+    };
+}
+
+TEST(SamplingMonitorTests, TestEveryNthSamplerKeepsFirstOfEachN)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::sampling_monitor sampler(perf_monitor, sage::performance::every_nth_sampler(4));
+    for (int i = 0; i < 10; ++i)
+    {
+        sampler.add_measurement(std::chrono::milliseconds(i));
+    }
+
+    ASSERT_EQ(sampler.calls(), 10);
+    ASSERT_EQ(sampler.sampled(), 3);
+    ASSERT_THAT(perf_monitor.get_measurements(), ::testing::ContainerEq(std::vector<double>({0, 4, 8})));
+}
+
+TEST(SamplingMonitorTests, TestSamplingTimerSkipsClockReads)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::sampling_monitor sampler(perf_monitor, sage::performance::every_nth_sampler(100));
+    counting_clock::reads = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        sage::performance::sampling_timer<decltype(sampler), counting_clock> t(sampler);
+    }
+
+    ASSERT_EQ(sampler.calls(), 1000);
+    ASSERT_EQ(perf_monitor.get_measurements().size(), 10);
+    ASSERT_EQ(counting_clock::reads, 20);
+    ASSERT_THAT(perf_monitor.get_measurements(), ::testing::Each(1.0));
+}
+
+TEST(SamplingMonitorTests, TestProbabilisticSamplerKeepsApproximateFraction)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::sampling_monitor sampler(perf_monitor, sage::performance::probabilistic_sampler(0.1, 42));
+    for (int i = 0; i < 100000; ++i)
+    {
+        sampler.add_measurement(std::chrono::microseconds(1));
+    }
+
+    ASSERT_EQ(sampler.calls(), 100000);
+    ASSERT_EQ(sampler.sampled(), perf_monitor.get_measurements().size());
+    ASSERT_THAT(sampler.sampled(), ::testing::AllOf(::testing::Gt(9000), ::testing::Lt(11000)));
+}
+
+TEST(SamplingMonitorTests, TestProbabilisticSamplerIsRepeatableForSeed)
+{
+    sage::performance::probabilistic_sampler first(0.5, 7);
+    sage::performance::probabilistic_sampler second(0.5, 7);
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        ASSERT_EQ(first(i), second(i));
+    }
+}
+
+TEST(SamplingMonitorTests, TestSamplersRejectInvalidArguments)
+{
+    ASSERT_THROW(sage::performance::every_nth_sampler(0), std::invalid_argument);
+    ASSERT_THROW(sage::performance::probabilistic_sampler(1.5), std::invalid_argument);
+    ASSERT_THROW(sage::performance::reservoir_monitor(0), std::invalid_argument);
+}
+
+TEST(SamplingMonitorTests, TestReservoirKeepsEverythingUntilFull)
+{
+    sage::performance::reservoir_monitor reservoir(4, 1);
+    for (int i = 1; i <= 3; ++i)
+    {
+        reservoir.add_measurement(std::chrono::milliseconds(i));
+    }
+
+    ASSERT_EQ(reservoir.calls(), 3);
+    ASSERT_THAT(reservoir.get_measurements(), ::testing::ContainerEq(std::vector<double>({1, 2, 3})));
+    ASSERT_DOUBLE_EQ(reservoir.average(), 2.0);
+}
+
+TEST(SamplingMonitorTests, TestReservoirIsBoundedAndUniform)
+{
+    sage::performance::reservoir_monitor reservoir(1000, 3);
+    constexpr int calls = 100000;
+    for (int i = 0; i < calls; ++i)
+    {
+        reservoir.add_measurement(std::chrono::milliseconds(i));
+    }
+
+    const auto measurements = reservoir.get_measurements();
+    ASSERT_EQ(reservoir.calls(), calls);
+    ASSERT_EQ(measurements.size(), 1000);
+    // A uniform sample of 0..99999 should be spread over the whole range
+    const auto in_first_half = std::count_if(measurements.begin(), measurements.end(), [](double m) { return m < calls / 2; });
+    ASSERT_THAT(in_first_half, ::testing::AllOf(::testing::Gt(400), ::testing::Lt(600)));
+    ASSERT_NEAR(reservoir.estimated_total(), reservoir.average() * calls, 1e-6);
+    ASSERT_NEAR(reservoir.average(), calls / 2.0, calls * 0.05);
+}
+
+TEST(SamplingMonitorTests, TestReservoirCountsCallsFromManyThreads)
+{
+    sage::performance::reservoir_monitor reservoir(64);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&reservoir]() {
+            for (int i = 0; i < 10000; ++i)
+            {
+                sage::performance::sampling_timer t(reservoir);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(reservoir.calls(), 40000);
+    ASSERT_EQ(reservoir.get_measurements().size(), 64);
+    ASSERT_THAT(reservoir.sampled(), ::testing::AllOf(::testing::Ge(64), ::testing::Lt(40000)));
+}
@@ -0,0 +1,92 @@
+#include <sage/performance/scaling_benchmark.hpp>
+#include <sage/performance/benchmark.hpp>
+
+#include <array>
+#include <atomic>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    sage::performance::scaling_options quick_scaling_options()
+    {
+        sage::performance::scaling_options options;
+        options.thread_counts = {1, 2};
+        options.target_time = std::chrono::milliseconds(2);
+        options.warmup_time = std::chrono::milliseconds(1);
+        options.repetitions = 3;
+        return options;
+    }
+}
+
+TEST(ScalingBenchmarkTests, TestThreadCountsDoubleUpToMaximum)
+{
+    ASSERT_THAT(sage::performance::scaling_thread_counts(1), testing::ElementsAre(1u));
+    ASSERT_THAT(sage::performance::scaling_thread_counts(6), testing::ElementsAre(1u, 2u, 4u, 6u));
+    ASSERT_THAT(sage::performance::scaling_thread_counts(8), testing::ElementsAre(1u, 2u, 4u, 8u));
+}
+
+TEST(ScalingBenchmarkTests, TestEachThreadRunsTheSameIterations)
+{
+    std::array<std::atomic<size_t>, 2> calls{};
+    const auto options = quick_scaling_options();
+    const auto result = sage::performance::run_scaling_benchmark("count", [&calls](size_t thread_index) {
+        calls[thread_index].fetch_add(1, std::memory_order_relaxed);
+    }, options);
+
+    ASSERT_EQ(result.name, "count");
+    ASSERT_EQ(result.points.size(), 2u);
+    ASSERT_EQ(result.points[0].threads, 1u);
+    ASSERT_EQ(result.points[1].threads, 2u);
+    ASSERT_EQ(result.points[0].iterations, result.points[1].iterations);
+    // Only the two thread run uses the second thread index
+    ASSERT_EQ(calls[1].load(), result.points[1].iterations * options.repetitions);
+}
+
+TEST(ScalingBenchmarkTests, TestSpeedupIsRelativeToSingleThread)
+{
+    std::atomic<uint64_t> shared{0};
+    const auto result = sage::performance::run_scaling_benchmark("shared_counter", [&shared]() {
+        shared.fetch_add(1, std::memory_order_relaxed);
+    }, quick_scaling_options());
+
+    const auto& single = result.points[0];
+    ASSERT_GT(single.wall_time, 0.0);
+    ASSERT_GT(single.throughput, 0.0);
+    ASSERT_DOUBLE_EQ(single.speedup, 1.0);
+    ASSERT_DOUBLE_EQ(single.efficiency, 1.0);
+    ASSERT_DOUBLE_EQ(single.imbalance, 1.0);
+    const auto& pair = result.points[1];
+    ASSERT_DOUBLE_EQ(pair.speedup, pair.throughput / single.throughput);
+    ASSERT_DOUBLE_EQ(pair.efficiency, pair.speedup / 2.0);
+    ASSERT_GE(pair.imbalance, 1.0);
+}
+
+TEST(ScalingBenchmarkTests, TestPinnedRunStillMeasures)
+{
+    auto options = quick_scaling_options();
+    options.pin_threads = true;
+    const auto result = sage::performance::run_scaling_benchmark("pinned", []() {
+        sage::performance::clobber_memory();
+    }, options);
+
+    ASSERT_EQ(result.points.size(), 2u);
+    ASSERT_GT(result.points[1].throughput, 0.0);
+}
+
+TEST(ScalingBenchmarkTests, TestScalingTableOutput)
+{
+    sage::performance::scaling_result result{"bench", {{1, 1000, 1e6, 1e6, 1.0, 1.0, 1.0, false}, {2, 1000, 1e6, 2e6, 2.0, 1.0, 1.05, true}}};
+    std::stringstream ss;
+    sage::performance::write_scaling_table(ss, result);
+
+    const auto table = ss.str();
+    ASSERT_THAT(table, testing::StartsWith("bench\n"));
+    ASSERT_THAT(table, testing::HasSubstr("efficiency"));
+    ASSERT_THAT(table, testing::HasSubstr("2.00M items/s"));
+    ASSERT_THAT(table, testing::HasSubstr("2.00x"));
+    ASSERT_THAT(table, testing::HasSubstr("100.0%"));
+    ASSERT_THAT(table, testing::HasSubstr("yes"));
+}
@@ -0,0 +1,88 @@
+#include <sage/performance/monitors.hpp>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+namespace
+{
+    void add_measurements(sage::performance::streaming_stats_monitor& monitor, const std::vector<int>& measurements_in_ms)
+    {
+        for (auto m : measurements_in_ms)
+        {
+            monitor.add_measurement(std::chrono::milliseconds(m));
+        }
+    }
+}
+
+TEST(StreamingStatsMonitorTests, TestStreamingStatsMonitorStatisticsAreCorrect)
+{
+    sage::performance::streaming_stats_monitor monitor;
+    add_measurements(monitor, {100, 200, 300, 400, 500});
+
+    ASSERT_EQ(monitor.count(), 5u);
+    ASSERT_THAT(monitor.total(), testing::DoubleEq(1500));
+    ASSERT_THAT(monitor.average(), testing::DoubleEq(300));
+    ASSERT_THAT(monitor.variance(), testing::DoubleEq(25000));
+    ASSERT_THAT(monitor.stddev(), testing::DoubleEq(std::sqrt(25000.0)));
+    ASSERT_THAT(monitor.min(), testing::DoubleEq(100));
+    ASSERT_THAT(monitor.max(), testing::DoubleEq(500));
+    ASSERT_THAT(monitor.s_total(), testing::StrEq("00:00:01:500"));
+    ASSERT_THAT(monitor.s_average(), testing::StrEq("00:00:00:300"));
+}
+
+TEST(StreamingStatsMonitorTests, TestStreamingStatsMonitorEmptyStatistics)
+{
+    sage::performance::streaming_stats_monitor monitor;
+
+    ASSERT_EQ(monitor.count(), 0u);
+    ASSERT_THAT(monitor.total(), testing::DoubleEq(0));
+    ASSERT_THAT(monitor.variance(), testing::DoubleEq(0));
+    ASSERT_TRUE(std::isnan(monitor.average()));
+    ASSERT_TRUE(std::isnan(monitor.min()));
+    ASSERT_TRUE(std::isnan(monitor.max()));
+}
+
+TEST(StreamingStatsMonitorTests, TestStreamingStatsMonitorMergeMatchesSingleMonitor)
+{
+    sage::performance::streaming_stats_monitor combined;
+    add_measurements(combined, {12, 7, 3, 45, 18, 1, 30, 22});
+
+    sage::performance::streaming_stats_monitor first;
+    add_measurements(first, {12, 7, 3});
+    sage::performance::streaming_stats_monitor second;
+    add_measurements(second, {45, 18, 1, 30, 22});
+    first.merge(second);
+
+    ASSERT_EQ(first.count(), combined.count());
+    ASSERT_THAT(first.average(), testing::DoubleNear(combined.average(), 1e-9));
+    ASSERT_THAT(first.variance(), testing::DoubleNear(combined.variance(), 1e-9));
+    ASSERT_THAT(first.min(), testing::DoubleEq(combined.min()));
+    ASSERT_THAT(first.max(), testing::DoubleEq(combined.max()));
+}
+
+TEST(StreamingStatsMonitorTests, TestStreamingStatsMonitorMergeWithEmptyMonitors)
+{
+    sage::performance::streaming_stats_monitor empty;
+    sage::performance::streaming_stats_monitor monitor;
+    add_measurements(monitor, {10, 20});
+
+    monitor.merge(empty);
+    ASSERT_EQ(monitor.count(), 2u);
+    ASSERT_THAT(monitor.average(), testing::DoubleEq(15));
+
+    empty.merge(monitor);
+    ASSERT_EQ(empty.count(), 2u);
+    ASSERT_THAT(empty.variance(), testing::DoubleEq(50));
+}
+
+TEST(StreamingStatsMonitorTests, TestStreamingStatsMonitorReset)
+{
+    sage::performance::streaming_stats_monitor monitor;
+    add_measurements(monitor, {10, 20});
+    monitor.reset();
+
+    ASSERT_EQ(monitor.count(), 0u);
+    monitor.add_measurement(std::chrono::microseconds(500));
+    ASSERT_THAT(monitor.min(), testing::DoubleEq(0.5));
+    ASSERT_THAT(monitor.max(), testing::DoubleEq(0.5));
+}
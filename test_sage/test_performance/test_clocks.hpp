@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Clocks for tests that need timings to come out exactly
+namespace sage_test
+{
+    // Clock that only moves when the test advances it
+    struct manual_clock
+    {
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::nanoseconds;
+        using time_point = std::chrono::time_point<manual_clock>;
+        static constexpr bool is_steady = true;
+
+        static inline time_point current{};
+
+        static time_point now()
+        {
+            return current;
+        }
+
+        static void advance(duration d)
+        {
+            current += d;
+        }
+    };
+
+    // Clock that moves on by a fixed number of nanoseconds every time it is read
+    template <int64_t StepNs>
+    struct stepping_clock
+    {
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::nanoseconds;
+        using time_point = std::chrono::time_point<stepping_clock>;
+        static constexpr bool is_steady = true;
+
+        static inline time_point current{};
+
+        static time_point now()
+        {
+            const auto reading = current;
+            current += std::chrono::nanoseconds(StepNs);
+            return reading;
+        }
+    };
+}
@@ -0,0 +1,85 @@
+#include <sage/performance/throughput_timer.hpp>
+
+#include <cmath>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(ThroughputTimerTests, TestSummaryMonitorMeanRatesAreWeightedByTime)
+{
+    sage::performance::throughput_summary_monitor monitor;
+    // 100 items/s over one second, then 1000 items/s over a tenth of a second
+    monitor.add_measurement(std::chrono::seconds(1), 100, 1000);
+    monitor.add_measurement(std::chrono::milliseconds(100), 100, 1000);
+
+    ASSERT_EQ(monitor.count(), 2u);
+    ASSERT_EQ(monitor.total_items(), 200u);
+    ASSERT_EQ(monitor.total_bytes(), 2000u);
+    ASSERT_DOUBLE_EQ(monitor.total(), 1100.0);
+    ASSERT_DOUBLE_EQ(monitor.average(), 550.0);
+    ASSERT_NEAR(monitor.items_per_second(), 200.0 / 1.1, 1e-9);
+    ASSERT_NEAR(monitor.bytes_per_second(), 2000.0 / 1.1, 1e-9);
+}
+
+TEST(ThroughputTimerTests, TestSummaryMonitorRatePercentilesAndPeak)
+{
+    sage::performance::throughput_summary_monitor monitor;
+    for (uint64_t items = 1; items <= 100; ++items)
+    {
+        monitor.add_measurement(std::chrono::seconds(1), items, items * 10);
+    }
+
+    ASSERT_DOUBLE_EQ(monitor.item_rate_percentile(50.0), 50.5);
+    ASSERT_DOUBLE_EQ(monitor.byte_rate_percentile(0.0), 10.0);
+    ASSERT_DOUBLE_EQ(monitor.peak_items_per_second(), 100.0);
+    ASSERT_DOUBLE_EQ(monitor.peak_bytes_per_second(), 1000.0);
+}
+
+TEST(ThroughputTimerTests, TestSummaryMonitorScopesWithoutDurationHaveNoRate)
+{
+    sage::performance::throughput_summary_monitor monitor;
+    monitor.add_measurement(std::chrono::nanoseconds(0), 10, 10);
+
+    ASSERT_EQ(monitor.total_items(), 10u);
+    ASSERT_DOUBLE_EQ(monitor.items_per_second(), 0.0);
+    ASSERT_TRUE(std::isnan(monitor.peak_items_per_second()));
+}
+
+TEST(ThroughputTimerTests, TestRatesAreFormattedWithSiPrefixes)
+{
+    ASSERT_EQ(sage::performance::format_item_rate(512.0), "512.00 items/s");
+    ASSERT_EQ(sage::performance::format_item_rate(12345678.0), "12.35M items/s");
+    ASSERT_EQ(sage::performance::format_byte_rate(999.0), "999.00 B/s");
+    ASSERT_EQ(sage::performance::format_byte_rate(45600000.0), "45.60 MB/s");
+    ASSERT_EQ(sage::performance::format_byte_rate(2.5e9), "2.50 GB/s");
+}
+
+TEST(ThroughputTimerTests, TestSummaryMonitorSummaryString)
+{
+    sage::performance::throughput_summary_monitor monitor;
+    monitor.add_measurement(std::chrono::seconds(2), 1200, 4800000);
+
+    ASSERT_EQ(monitor.s_items_per_second(), "600.00 items/s");
+    ASSERT_EQ(monitor.s_bytes_per_second(), "2.40 MB/s");
+    ASSERT_EQ(monitor.s_total(), "00:00:02:000");
+    ASSERT_THAT(monitor.s_summary(), testing::StartsWith("1200 items, 4800000 bytes in 00:00:02:000, 600.00 items/s (p50 600.00 items/s"));
+}
+
+TEST(ThroughputTimerTests, TestThroughputTimerReportsWorkDoneInScope)
+{
+    sage::performance::throughput_summary_monitor monitor;
+    {
+        sage::performance::throughput_timer t(monitor, 10, 100);
+        t.add_items(5);
+        t.add_bytes(50);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_EQ(monitor.count(), 1u);
+    ASSERT_EQ(monitor.total_items(), 15u);
+    ASSERT_EQ(monitor.total_bytes(), 150u);
+    ASSERT_GE(monitor.total(), 10.0);
+    ASSERT_GT(monitor.items_per_second(), 0.0);
+    ASSERT_LE(monitor.items_per_second(), 1500.0);
+}
@@ -0,0 +1,143 @@
+#include <sage/performance/monitors.hpp>
+#include <sage/performance/tsc_clock.hpp>
+
+#include <memory>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "test_clocks.hpp"
+
+TEST(TimerTests, TestMeasureReturnsCallableResult)
+{
+    sage::performance::performance_monitor perf_monitor;
+    const auto result = sage::performance::measure(perf_monitor, [](int a, int b) { return a + b; }, 2, 3);
+
+    ASSERT_EQ(result, 5);
+    ASSERT_EQ(perf_monitor.get_measurements().size(), 1u);
+}
+
+TEST(TimerTests, TestMeasureForwardsMoveOnlyArgumentsAndResults)
+{
+    sage::performance::performance_monitor perf_monitor;
+    auto value = std::make_unique<int>(42);
+    auto result = sage::performance::measure(perf_monitor, [](std::unique_ptr<int> p) { return p; }, std::move(value));
+
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(*result, 42);
+}
+
+TEST(TimerTests, TestMeasureReturnsReferences)
+{
+    sage::performance::performance_monitor perf_monitor;
+    int target = 0;
+    int& reference = sage::performance::measure(perf_monitor, [&target]() -> int& { return target; });
+    reference = 7;
+
+    ASSERT_EQ(target, 7);
+}
+
+TEST(TimerTests, TestMeasureWithAlternativeClock)
+{
+    sage::performance::performance_monitor perf_monitor;
+    sage::performance::measure<sage::performance::tsc_clock>(perf_monitor, []() {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    });
+
+    ASSERT_EQ(perf_monitor.get_measurements().size(), 1u);
+    ASSERT_GE(perf_monitor.total(), 0.1);
+}
+
+TEST(TimerTests, TestTimersAreEnabledByDefault)
+{
+    ASSERT_TRUE(sage::performance::timers_enabled);
+}
+
+namespace
+{
+    using sage_test::manual_clock;
+
+    using manual_timer = sage::performance::basic_timer<manual_clock>;
+}
+
+TEST(TimerTests, TestPausedTimeIsNotMeasured)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        manual_timer t(perf_monitor);
+        manual_clock::advance(std::chrono::milliseconds(2));
+        t.pause();
+        ASSERT_FALSE(t.is_running());
+        manual_clock::advance(std::chrono::milliseconds(100));
+        t.pause();
+        t.resume();
+        ASSERT_TRUE(t.is_running());
+        manual_clock::advance(std::chrono::milliseconds(3));
+    }
+
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(5.0)));
+}
+
+TEST(TimerTests, TestTimerPausedAtTheEndReportsTimeBeforePause)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        manual_timer t(perf_monitor);
+        manual_clock::advance(std::chrono::milliseconds(4));
+        t.pause();
+        manual_clock::advance(std::chrono::milliseconds(100));
+    }
+
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(4.0)));
+}
+
+TEST(TimerTests, TestCancelledTimerReportsNothing)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        manual_timer t(perf_monitor);
+        manual_clock::advance(std::chrono::milliseconds(1));
+        t.cancel();
+        ASSERT_FALSE(t.is_running());
+    }
+
+    ASSERT_TRUE(perf_monitor.get_measurements().empty());
+}
+
+TEST(TimerTests, TestMovedTimerReportsOnce)
+{
+    sage::performance::performance_monitor perf_monitor;
+    std::optional<manual_timer> moved;
+    {
+        manual_timer t(perf_monitor);
+        manual_clock::advance(std::chrono::milliseconds(2));
+        t.pause();
+        moved.emplace(std::move(t));
+    }
+    ASSERT_TRUE(perf_monitor.get_measurements().empty());
+
+    moved->resume();
+    manual_clock::advance(std::chrono::milliseconds(3));
+    moved.reset();
+
+    ASSERT_THAT(perf_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(5.0)));
+}
+
+TEST(TimerTests, TestMoveAssignmentReportsReplacedTimer)
+{
+    sage::performance::performance_monitor first_monitor;
+    sage::performance::performance_monitor second_monitor;
+    {
+        manual_timer first(first_monitor);
+        manual_clock::advance(std::chrono::milliseconds(1));
+        manual_timer second(second_monitor);
+        manual_clock::advance(std::chrono::milliseconds(2));
+        first = std::move(second);
+        ASSERT_THAT(first_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(3.0)));
+        manual_clock::advance(std::chrono::milliseconds(1));
+    }
+
+    ASSERT_THAT(first_monitor.get_measurements(), testing::SizeIs(1));
+    ASSERT_THAT(second_monitor.get_measurements(), testing::ElementsAre(testing::DoubleEq(3.0)));
+}
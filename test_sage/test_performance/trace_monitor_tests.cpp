@@ -0,0 +1,169 @@
+#include <sage/performance/timer.hpp>
+#include <sage/performance/trace_monitor.hpp>
+
+#include <sstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "test_clocks.hpp"
+
+namespace
+{
+    size_t count_occurrences(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+        for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + pattern.size()))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    std::string flush(sage::performance::trace_recorder& recorder)
+    {
+        std::stringstream ss;
+        recorder.write_chrome_trace(ss);
+        return ss.str();
+    }
+}
+
+TEST(TraceMonitorTests, TestTraceMonitorWritesCompleteEvents)
+{
+    sage::performance::trace_recorder recorder;
+    sage::performance::trace_monitor outer(recorder, "outer");
+    sage::performance::trace_monitor inner(recorder, "inner");
+    {
+        sage::performance::trace_timer outer_timer(outer);
+        for (int i = 0; i < 2; ++i)
+        {
+            sage::performance::trace_timer inner_timer(inner);
+        }
+    }
+
+    const auto trace = flush(recorder);
+    ASSERT_THAT(trace, ::testing::StartsWith("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    ASSERT_EQ(count_occurrences(trace, "\"ph\":\"X\""), 3u);
+    ASSERT_EQ(count_occurrences(trace, "\"name\":\"inner\""), 2u);
+    ASSERT_EQ(count_occurrences(trace, "\"name\":\"outer\""), 1u);
+    ASSERT_EQ(count_occurrences(trace, "\"name\":\"thread_name\""), 1u);
+}
+
+TEST(TraceMonitorTests, TestTraceRecorderFlushEmptiesBuffers)
+{
+    sage::performance::trace_recorder recorder;
+    sage::performance::trace_monitor monitor(recorder, "span");
+    monitor.add_measurement(std::chrono::microseconds(10));
+
+    ASSERT_EQ(count_occurrences(flush(recorder), "\"ph\":\"X\""), 1u);
+    ASSERT_EQ(count_occurrences(flush(recorder), "\"ph\":\"X\""), 0u);
+}
+
+TEST(TraceMonitorTests, TestTraceRecorderRecordsEachThreadSeparately)
+{
+    sage::performance::trace_recorder recorder;
+    sage::performance::trace_monitor monitor(recorder, "worker");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t)
+    {
+        threads.emplace_back([&monitor]() {
+            sage::performance::timer timer(monitor);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto trace = flush(recorder);
+    ASSERT_EQ(count_occurrences(trace, "\"name\":\"thread_name\""), 3u);
+    ASSERT_EQ(count_occurrences(trace, "\"name\":\"worker\""), 3u);
+}
+
+TEST(TraceMonitorTests, TestTraceRecorderCanBeDisabledAtRuntime)
+{
+    sage::performance::trace_recorder recorder(16, false);
+    sage::performance::trace_monitor monitor(recorder, "span");
+    monitor.add_measurement(std::chrono::microseconds(10));
+    ASSERT_FALSE(recorder.enabled());
+
+    recorder.enable();
+    monitor.add_measurement(std::chrono::microseconds(10));
+    recorder.disable();
+    monitor.add_measurement(std::chrono::microseconds(10));
+
+    ASSERT_EQ(count_occurrences(flush(recorder), "\"ph\":\"X\""), 1u);
+}
+
+TEST(TraceMonitorTests, TestTraceRecorderBufferIsBounded)
+{
+    sage::performance::trace_recorder recorder(4);
+    sage::performance::trace_monitor monitor(recorder, "span");
+    for (int i = 0; i < 10; ++i)
+    {
+        monitor.add_measurement(std::chrono::microseconds(1));
+    }
+
+    ASSERT_EQ(recorder.dropped_events(), 6u);
+    const auto trace = flush(recorder);
+    ASSERT_EQ(count_occurrences(trace, "\"ph\":\"X\""), 4u);
+    ASSERT_THAT(trace, ::testing::HasSubstr("\"dropped\":6"));
+    ASSERT_EQ(recorder.dropped_events(), 0u);
+}
+
+TEST(TraceMonitorTests, TestTraceMonitorEscapesNames)
+{
+    sage::performance::trace_recorder recorder;
+    sage::performance::trace_monitor monitor(recorder, "say \"hi\"\\");
+    monitor.add_measurement(std::chrono::microseconds(1));
+
+    ASSERT_THAT(flush(recorder), ::testing::HasSubstr("\"name\":\"say \\\"hi\\\"\\\\\""));
+}
+
+TEST(TraceMonitorTests, TestTraceTimerRecordsBeginTimeAndClockDuration)
+{
+    sage::performance::trace_recorder recorder;
+    sage::performance::trace_monitor monitor(recorder, "span");
+    {
+        sage::performance::basic_trace_timer<sage_test::manual_clock> t(monitor);
+        sage_test::manual_clock::advance(std::chrono::milliseconds(1));
+        // Wall time passes without the test clock moving, a begin time worked back from the
+        // end of the span would land after it
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    const auto trace = flush(recorder);
+    const auto span = trace.find("\"name\":\"span\"");
+    ASSERT_NE(span, std::string::npos);
+    ASSERT_THAT(trace.substr(span), ::testing::HasSubstr("\"dur\":1000.000"));
+    const auto ts = trace.find("\"ts\":", span);
+    ASSERT_LT(std::stod(trace.substr(ts + 5)), 25000.0);
+}
+
+TEST(TraceMonitorTests, TestTraceTimerDoesNothingWhileDisabled)
+{
+    sage::performance::trace_recorder recorder(16, false);
+    sage::performance::trace_monitor monitor(recorder, "span");
+    {
+        sage::performance::trace_timer t(monitor);
+        recorder.enable();
+    }
+
+    ASSERT_EQ(count_occurrences(flush(recorder), "\"ph\":\"X\""), 0u);
+}
+
+TEST(TraceMonitorTests, TestWritingTraceLeavesStreamFormatting)
+{
+    sage::performance::trace_recorder recorder;
+    sage::performance::trace_monitor monitor(recorder, "span");
+    monitor.add_span(std::chrono::steady_clock::now(), std::chrono::microseconds(1));
+
+    std::stringstream ss;
+    recorder.write_chrome_trace(ss);
+    ss.str("");
+    ss << 1.5;
+
+    ASSERT_EQ(ss.str(), "1.5");
+    ASSERT_EQ(ss.precision(), 6);
+}
@@ -0,0 +1,68 @@
+#include <sage/performance/tsc_clock.hpp>
+#include <sage/performance/monitors.hpp>
+#include <sage/performance/statistics.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+TEST(TscClockTests, TestTscClockIsMonotonic)
+{
+    auto previous = sage::performance::tsc_clock::now();
+    for (int i = 0; i < 10000; ++i)
+    {
+        const auto current = sage::performance::tsc_clock::now();
+        ASSERT_GE(current, previous);
+        previous = current;
+    }
+}
+
+TEST(TscClockTests, TestTscClockAgreesWithSteadyClock)
+{
+    // The two clocks are read one after the other, so a preemption between the reads skews a
+    // single interval. The median ratio of several short intervals is not moved by a few.
+    std::vector<double> ratios;
+    for (int i = 0; i < 15; ++i)
+    {
+        const auto tsc_start = sage::performance::tsc_clock::start_now();
+        const auto steady_start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - steady_start < std::chrono::milliseconds(5))
+        {
+        }
+        const auto tsc_end = sage::performance::tsc_clock::stop_now();
+        const auto steady_end = std::chrono::steady_clock::now();
+
+        const auto tsc_elapsed = std::chrono::duration<double, std::milli>(tsc_end - tsc_start).count();
+        const auto steady_elapsed = std::chrono::duration<double, std::milli>(steady_end - steady_start).count();
+        ratios.push_back(tsc_elapsed / steady_elapsed);
+    }
+
+    ASSERT_THAT(sage::performance::statistics::median(ratios), testing::DoubleNear(1.0, 0.05));
+}
+
+TEST(TscClockTests, TestTscClockReportsCalibration)
+{
+    if (sage::performance::tsc_clock::is_using_tsc())
+    {
+        ASSERT_GT(sage::performance::tsc_clock::ticks_per_second(), 0.0);
+    }
+    else
+    {
+        ASSERT_THAT(sage::performance::tsc_clock::ticks_per_second(), testing::DoubleEq(0.0));
+    }
+}
+
+TEST(TscClockTests, TestTscTimerReportsToMonitor)
+{
+    sage::performance::performance_monitor perf_monitor;
+    {
+        sage::performance::tsc_timer t(perf_monitor);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    ASSERT_EQ(perf_monitor.get_measurements().size(), 1u);
+    ASSERT_GE(perf_monitor.total(), 0.1);
+}
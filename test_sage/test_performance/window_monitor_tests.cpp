@@ -0,0 +1,90 @@
+#include <sage/performance/window_monitor.hpp>
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "test_clocks.hpp"
+
+namespace
+{
+    using sage_test::manual_clock;
+
+    using manual_window_monitor = sage::performance::basic_window_monitor<manual_clock>;
+}
+
+TEST(WindowMonitorTests, TestWindowMonitorCountsRecentMeasurements)
+{
+    manual_window_monitor monitor(std::chrono::seconds(1), 10);
+    for (int second = 0; second < 5; ++second)
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            monitor.add_measurement(std::chrono::milliseconds(second + 1));
+        }
+        manual_clock::advance(std::chrono::seconds(1));
+    }
+
+    ASSERT_EQ(monitor.count(std::chrono::seconds(10)), 50);
+    // The current second is empty, the previous one holds the 5ms measurements
+    ASSERT_EQ(monitor.count(std::chrono::seconds(2)), 10);
+    ASSERT_DOUBLE_EQ(monitor.snapshot(std::chrono::seconds(2)).max(), 5.0);
+    ASSERT_EQ(monitor.count(std::chrono::seconds(1)), 0);
+    ASSERT_TRUE(std::isnan(monitor.value_at_percentile(std::chrono::seconds(1), 50.0)));
+}
+
+TEST(WindowMonitorTests, TestWindowMonitorExpiresOldBuckets)
+{
+    manual_window_monitor monitor(std::chrono::seconds(1), 5);
+    monitor.add_measurement(std::chrono::milliseconds(100));
+    manual_clock::advance(std::chrono::seconds(3));
+    monitor.add_measurement(std::chrono::milliseconds(1));
+
+    ASSERT_EQ(monitor.count(std::chrono::seconds(5)), 2);
+
+    // The first measurement's slot is reused once the ring wraps around
+    manual_clock::advance(std::chrono::seconds(2));
+    monitor.add_measurement(std::chrono::milliseconds(1));
+    ASSERT_EQ(monitor.count(std::chrono::seconds(5)), 2);
+    ASSERT_NEAR(monitor.value_at_percentile(std::chrono::seconds(5), 100.0), 1.0, 0.01);
+
+    manual_clock::advance(std::chrono::seconds(10));
+    ASSERT_EQ(monitor.count(std::chrono::seconds(5)), 0);
+}
+
+TEST(WindowMonitorTests, TestWindowMonitorRate)
+{
+    manual_window_monitor monitor(std::chrono::milliseconds(100), 100);
+    // 200 measurements a second for 5 seconds
+    for (int i = 0; i < 1000; ++i)
+    {
+        manual_clock::advance(std::chrono::milliseconds(5));
+        monitor.add_measurement(std::chrono::microseconds(50));
+    }
+
+    ASSERT_NEAR(monitor.rate(std::chrono::seconds(1)), 200.0, 10.0);
+    // Only 5 of the 10 seconds have passed since construction
+    ASSERT_NEAR(monitor.rate(std::chrono::seconds(10)), 200.0, 1.0);
+}
+
+TEST(WindowMonitorTests, TestWindowMonitorPercentiles)
+{
+    manual_window_monitor monitor(std::chrono::seconds(1), 60);
+    for (int i = 1; i <= 100; ++i)
+    {
+        monitor.add_measurement(std::chrono::milliseconds(i));
+    }
+
+    ASSERT_NEAR(monitor.value_at_percentile(std::chrono::seconds(10), 50.0), 50.0, 0.5);
+    ASSERT_NEAR(monitor.value_at_percentile(std::chrono::seconds(10), 99.0), 99.0, 1.0);
+}
+
+TEST(WindowMonitorTests, TestWindowMonitorRejectsInvalidWindows)
+{
+    ASSERT_THROW(manual_window_monitor(std::chrono::seconds(1), 0), std::invalid_argument);
+    manual_window_monitor monitor(std::chrono::seconds(1), 10);
+    ASSERT_EQ(monitor.max_window(), std::chrono::seconds(10));
+    ASSERT_THROW(static_cast<void>(monitor.count(std::chrono::seconds(11))), std::invalid_argument);
+    ASSERT_THROW(static_cast<void>(monitor.count(std::chrono::seconds(0))), std::invalid_argument);
+}
@@ -0,0 +1,85 @@
+// Compares two sets of measurements, e.g. benchmark runs before and after a change, and exits
+// with 1 if anything got significantly slower
+#include "sage/argparse/argparse.hpp"
+#include "sage/performance/compare.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    // Parses a whole option value as a number, std::stod alone accepts trailing text
+    double parse_number(sage::argparse::argument_parser& parser, const std::string& name)
+    {
+        const auto text = parser.get<std::string>(name);
+        size_t parsed = 0;
+        double value = 0.0;
+        try
+        {
+            value = std::stod(text, &parsed);
+        }
+        catch (const std::exception&)
+        {
+            parsed = 0;
+        }
+        if (parsed == 0 || parsed != text.size())
+        {
+            throw std::invalid_argument("Error: --" + name + " must be a number, not " + text + ".");
+        }
+        return value;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = sage::argparse::argument_parser("sage_compare", "Compares a candidate set of measurements against a baseline.");
+    parser.add_argument("baseline").help("Baseline measurements, benchmark CSV output, a binary log or one measurement in milliseconds per line.");
+    parser.add_argument("candidate").help("Candidate measurements, in any of the baseline formats.");
+    parser.add_argument({"-a", "--alpha"}).default_value(std::string("0.05")).help("Significance level of the Mann-Whitney U test.");
+    parser.add_argument({"-t", "--threshold"}).default_value(std::string("0")).help("Smallest change of the median in percent reported as faster or slower.");
+    parser.add_argument({"-c", "--confidence"}).default_value(std::string("0.95")).help("Confidence level of the speedup interval.");
+    parser.add_argument({"-s", "--set-name"}).default_value(std::string("measurements")).help("Name given to the set in a text file, so text files from two runs are compared with each other.");
+    parser.add_argument({"-n", "--no-colour"}).num_args(0).help("Print the report without colours.");
+    parser.parse_args(argc, argv);
+
+    try
+    {
+        sage::performance::compare_options options;
+        options.alpha = parse_number(parser, "alpha");
+        options.threshold = parse_number(parser, "threshold") / 100.0;
+        options.confidence = parse_number(parser, "confidence");
+        if (!(options.alpha > 0.0 && options.alpha < 1.0))
+        {
+            throw std::invalid_argument("Error: --alpha must be between 0 and 1.");
+        }
+        if (!(options.threshold >= 0.0))
+        {
+            throw std::invalid_argument("Error: --threshold must not be negative.");
+        }
+        if (!(options.confidence > 0.0 && options.confidence < 1.0))
+        {
+            throw std::invalid_argument("Error: --confidence must be between 0 and 1.");
+        }
+
+        const auto set_name = parser.get<std::string>("set-name");
+        const auto baseline = sage::performance::load_measurements(parser.get<std::string>("baseline"), set_name);
+        const auto candidate = sage::performance::load_measurements(parser.get<std::string>("candidate"), set_name);
+        const auto results = sage::performance::compare_measurements(baseline, candidate, options);
+        sage::performance::write_comparison_table(std::cout, results, !parser.get<bool>("no-colour"));
+        if (!sage::performance::any_compared(results))
+        {
+            throw std::runtime_error("Error: No measurements are named the same in the baseline and the candidate, nothing was compared.");
+        }
+
+        const bool regressed = std::any_of(results.begin(), results.end(), [](const auto& result) {
+            return result.verdict == sage::performance::comparison_verdict::slower;
+        });
+        return regressed ? 1 : 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}